@@ -0,0 +1,106 @@
+#pragma once
+
+#include "utils/aligned_allocator.hpp"
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace song_processor {
+namespace audio {
+
+// Non-owning view over planar audio: channel c starts at
+// data + c * channelStride. Views never copy; narrowing to a channel or a
+// frame range just offsets the pointer. Sample is float for writable views
+// and const float for read-only ones.
+template <typename Sample>
+class BasicAudioBufferView {
+public:
+    BasicAudioBufferView() = default;
+    BasicAudioBufferView(Sample* data, int channels, size_t frames, size_t channelStride)
+        : data(data), channels(channels), frames(frames), channelStride(channelStride) {}
+
+    // A writable view converts to a read-only one
+    template <typename Other, typename = std::enable_if_t<std::is_same<Other, float>::value &&
+                                                          std::is_const<Sample>::value>>
+    BasicAudioBufferView(const BasicAudioBufferView<Other>& other)
+        : data(other.getChannel(0)), channels(other.getChannels()), frames(other.getFrameCount()),
+          channelStride(other.getChannelStride()) {}
+
+    int getChannels() const { return channels; }
+    size_t getFrameCount() const { return frames; }
+    size_t getChannelStride() const { return channelStride; }
+    bool empty() const { return frames == 0 || channels == 0; }
+
+    // Contiguous samples of one channel
+    Sample* getChannel(int channel) const { return data + channel * channelStride; }
+
+    // Frames [startFrame, startFrame + count) of every channel
+    BasicAudioBufferView subView(size_t startFrame, size_t count) const {
+        return BasicAudioBufferView(data + startFrame, channels, count, channelStride);
+    }
+
+    // Channels [firstChannel, firstChannel + count)
+    BasicAudioBufferView channelRange(int firstChannel, int count) const {
+        return BasicAudioBufferView(getChannel(firstChannel), count, frames, channelStride);
+    }
+
+private:
+    Sample* data = nullptr;
+    int channels = 0;
+    size_t frames = 0;
+    size_t channelStride = 0;
+};
+
+using AudioBufferView = BasicAudioBufferView<float>;
+using ConstAudioBufferView = BasicAudioBufferView<const float>;
+
+// Owning planar multichannel buffer. All channels live in one allocation;
+// every channel starts on a 64-byte boundary so per-channel loops run over
+// contiguous, aligned memory. Interleaved data is converted only at the
+// I/O boundary through the interleave/deinterleave calls.
+class AudioBuffer {
+public:
+    AudioBuffer() = default;
+    AudioBuffer(int channels, size_t frames, int sampleRate = 44100);
+
+    // Build from interleaved samples
+    static AudioBuffer fromInterleaved(const float* interleaved, size_t frames, int channels, int sampleRate);
+
+    // Reshape; contents are cleared to silence
+    void resize(int channels, size_t frames);
+    void clear();
+
+    int getChannels() const { return channels; }
+    size_t getFrameCount() const { return frames; }
+    int getSampleRate() const { return sampleRate; }
+    void setSampleRate(int rate) { sampleRate = rate; }
+    bool empty() const { return frames == 0 || channels == 0; }
+
+    float* getChannel(int channel) { return storage.data() + channel * channelStride; }
+    const float* getChannel(int channel) const { return storage.data() + channel * channelStride; }
+
+    AudioBufferView view() { return AudioBufferView(storage.data(), channels, frames, channelStride); }
+    ConstAudioBufferView view() const { return ConstAudioBufferView(storage.data(), channels, frames, channelStride); }
+
+    // Interleaved frames in, starting at startFrame of this buffer
+    void deinterleave(const float* interleaved, size_t startFrame, size_t count);
+
+    // Interleaved frames out, starting at startFrame of this buffer
+    void interleave(float* interleaved, size_t startFrame, size_t count) const;
+
+    std::vector<float> toInterleaved() const;
+
+private:
+    utils::AlignedVector<float> storage;
+    int channels = 0;
+    size_t frames = 0;
+    size_t channelStride = 0;
+    int sampleRate = 44100;
+};
+
+// Conversions between interleaved and planar layouts of the same frames
+void deinterleave(const float* interleaved, AudioBufferView output);
+void interleave(ConstAudioBufferView input, float* interleaved);
+
+} // namespace audio
+} // namespace song_processor
@@ -1,8 +1,12 @@
 #pragma once
 
+#include "audio_buffer.hpp"
+#include "audio_view.hpp"
+#include "mapped_audio_file.hpp"
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstdint>
 
 namespace song_processor {
 namespace audio {
@@ -22,7 +26,21 @@ public:
     // Load audio from file
     std::unique_ptr<AudioData> loadFromFile(const std::string& filename);
     
+    // Load audio from file into a planar buffer, one aligned block per channel
+    AudioBuffer loadBuffer(const std::string& filename);
+    
+    // Map a WAV/RF64 file without decoding it; samples are read through
+    // the returned file's AudioView
+    std::unique_ptr<MappedAudioFile> openFile(const std::string& filename);
+    
+    // Parse a WAV/RF64 image held in caller-owned memory, such as a network
+    // buffer, without copying it. The returned view borrows data, which
+    // must outlive it; samples are converted block by block on readFrames.
+    // Throws std::runtime_error on malformed input.
+    AudioView openMemory(const uint8_t* data, size_t size) const;
+    
     // Load audio from memory
+    std::unique_ptr<AudioData> loadFromMemory(const uint8_t* data, size_t size);
     std::unique_ptr<AudioData> loadFromMemory(const std::vector<uint8_t>& data);
     
     // Get supported formats
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace song_processor {
+namespace audio {
+
+enum class SampleFormat {
+    INT16,
+    INT24,
+    INT32,
+    FLOAT32
+};
+
+// Non-owning view over interleaved PCM sample bytes. The view never copies
+// the underlying data; integer formats are converted to float on demand,
+// one block at a time, through readFrames().
+class AudioView {
+public:
+    AudioView() = default;
+    AudioView(const uint8_t* data, size_t frameCount, int channels, int sampleRate, SampleFormat format);
+
+    // Format information
+    size_t getFrameCount() const { return frameCount; }
+    int getChannels() const { return channels; }
+    int getSampleRate() const { return sampleRate; }
+    SampleFormat getFormat() const { return format; }
+    int getBitsPerSample() const;
+    size_t getBytesPerFrame() const;
+    bool empty() const { return frameCount == 0; }
+
+    // Raw sample bytes
+    const uint8_t* getData() const { return data; }
+
+    // Direct access to float samples; nullptr unless the data is FLOAT32
+    // and suitably aligned for in-place use
+    const float* getFloatData() const;
+
+    // Convert frames [startFrame, startFrame + frames) to interleaved float.
+    // Returns the number of frames written to output.
+    size_t readFrames(size_t startFrame, float* output, size_t frames) const;
+
+    // View over a sub-range of frames
+    AudioView subView(size_t startFrame, size_t frames) const;
+
+private:
+    const uint8_t* data = nullptr;
+    size_t frameCount = 0;
+    int channels = 0;
+    int sampleRate = 0;
+    SampleFormat format = SampleFormat::FLOAT32;
+};
+
+} // namespace audio
+} // namespace song_processor
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "audio_buffer.hpp"
 #include "audio_loader.hpp"
+#include "audio_view.hpp"
 #include <string>
 
 namespace song_processor {
@@ -11,12 +13,18 @@ public:
     AudioWriter();
     ~AudioWriter();
     
-    // Write audio to file
+    // Write audio to a WAV file, streamed through a WavStreamWriter.
+    // bitsPerSample selects 16- or 24-bit PCM, or 32-bit float.
     bool writeToFile(const AudioData& audioData, const std::string& filename);
+    bool writeToFile(const AudioBuffer& buffer, const std::string& filename,
+                     SampleFormat format = SampleFormat::INT24);
     
-    // Write audio to memory
+    // Write audio to memory as a complete WAV image; only "wav" is supported
     std::vector<uint8_t> writeToMemory(const AudioData& audioData, const std::string& format);
     
+    // TPDF dither when reducing to 16 or 24 bits; off by default
+    void setDither(bool enabled);
+    
     // Get supported output formats
     std::vector<std::string> getSupportedFormats() const;
     
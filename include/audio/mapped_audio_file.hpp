@@ -0,0 +1,34 @@
+#pragma once
+
+#include "audio_view.hpp"
+#include <string>
+#include <memory>
+
+namespace song_processor {
+namespace audio {
+
+// Read-only memory mapping of a WAV/RF64 file. The header is parsed once
+// when the file is opened; the sample data is exposed in place through an
+// AudioView and paged in by the OS as it is read.
+class MappedAudioFile {
+public:
+    // Throws std::runtime_error if the file cannot be mapped or parsed
+    explicit MappedAudioFile(const std::string& filename);
+    ~MappedAudioFile();
+
+    MappedAudioFile(const MappedAudioFile&) = delete;
+    MappedAudioFile& operator=(const MappedAudioFile&) = delete;
+
+    // View over the sample data, valid for the lifetime of this object
+    const AudioView& getView() const;
+
+    const std::string& getFilename() const;
+    size_t getFileSize() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace audio
+} // namespace song_processor
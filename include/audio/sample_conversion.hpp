@@ -0,0 +1,47 @@
+#pragma once
+
+#include "audio_view.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace song_processor {
+namespace audio {
+
+// Triangular (TPDF) dither noise for reducing word length. Each value is
+// the difference of two uniform variables drawn from one xorshift step,
+// spanning (-1, 1) LSB, which decorrelates the requantisation error from
+// the signal at a cost of one random number per sample. Four generators
+// run interleaved so consecutive samples do not wait on each other.
+class TpdfDither {
+public:
+    explicit TpdfDither(uint32_t seed = 0x9E3779B9u);
+
+    void setSeed(uint32_t seed);
+
+    // Noise in units of one LSB of the target format
+    void generate(float* noise, size_t count);
+
+private:
+    static constexpr int LANES = 4;
+    uint32_t state[LANES];
+};
+
+size_t getBytesPerSample(SampleFormat format);
+
+// Little-endian PCM to float in [-1, 1). Integer formats are scaled by
+// their full-scale value (2^15, 2^23, 2^31); INT24 is packed, three bytes
+// per sample.
+void decodeSamples(const uint8_t* input, SampleFormat format, float* output, size_t count);
+
+// Float to little-endian PCM. Integer formats are rounded to nearest and
+// clamped to full scale, with NaN written as silence; when a dither source
+// is supplied its noise is added before rounding. FLOAT32 is copied as is.
+void encodeSamples(const float* input, SampleFormat format, uint8_t* output, size_t count,
+                   TpdfDither* dither = nullptr);
+
+// Native integer samples holding a bits-wide value (16, 24 or 32)
+void decodeSamples(const int32_t* input, int bits, float* output, size_t count);
+void encodeSamples(const float* input, int bits, int32_t* output, size_t count, TpdfDither* dither = nullptr);
+
+} // namespace audio
+} // namespace song_processor
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "audio_buffer.hpp"
+#include "audio_view.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace song_processor {
+namespace audio {
+
+// Incremental WAV writer for output that is produced block by block.
+// Blocks are converted to the target sample format into a reusable staging
+// buffer, which reaches the file in large chunks at chunk-aligned offsets.
+// The RIFF sizes are patched when the stream is closed, switching the
+// header to RF64 if the data outgrew 4 GiB.
+class WavStreamWriter {
+public:
+    // Throws std::runtime_error if the file cannot be created
+    WavStreamWriter(const std::string& filename, int sampleRate, int channels,
+                    SampleFormat format = SampleFormat::INT24);
+
+    // Closes the stream if still open; errors at that point are swallowed,
+    // so call close() to see them
+    ~WavStreamWriter();
+
+    WavStreamWriter(const WavStreamWriter&) = delete;
+    WavStreamWriter& operator=(const WavStreamWriter&) = delete;
+
+    // TPDF dither when reducing to an integer format; off by default
+    void setDither(bool enabled);
+
+    // Append interleaved frames. Throws std::runtime_error on I/O failure.
+    void write(const float* interleaved, size_t frames);
+
+    // Append planar frames; the view must have the stream's channel count
+    void write(ConstAudioBufferView block);
+
+    // Flush buffered data and finalise the header
+    void close();
+
+    bool isOpen() const;
+    size_t getFramesWritten() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace audio
+} // namespace song_processor
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "signal/filter.hpp"
 #include <vector>
 #include <string>
+#include <memory>
+#include <cstddef>
 
 namespace song_processor {
 namespace effects {
@@ -13,7 +16,9 @@ struct CompressorParameters {
     double release = 100.0;    // Release time in ms
     double knee = 6.0;         // Knee width in dB
     double makeup = 0.0;       // Makeup gain in dB
+    double lookahead = 0.0;    // Look-ahead in ms (0.0 to 20.0)
     int sampleRate = 44100;
+    int channels = 1;          // Interleaved channels per frame
 };
 
 class Compressor {
@@ -24,6 +29,19 @@ public:
     // Apply compression
     std::vector<float> apply(const std::vector<float>& input);
     
+    // Process a block of interleaved frames. State carries over between
+    // calls, so a signal may be fed in blocks of any size. input and
+    // output may point to the same buffer.
+    void process(const float* input, float* output, size_t frames);
+    
+    // Process a block keyed by an external side-chain block of the same
+    // length, read in place: sideChain holds frames interleaved frames of
+    // sideChainChannels channels, and the loudest of them drives the gain.
+    // sideChainChannels must match setSideChainChannels; a different count
+    // throws std::invalid_argument rather than reallocating mid-stream.
+    void process(const float* input, float* output, size_t frames,
+                 const float* sideChain, int sideChainChannels = 1);
+    
     // Set compressor parameters
     void setParameters(const CompressorParameters& params);
     void setThreshold(double threshold);
@@ -32,11 +50,16 @@ public:
     void setRelease(double release);
     void setKnee(double knee);
     void setMakeupGain(double makeup);
+    void setLookahead(double lookahead);
     void setSampleRate(int sampleRate);
+    void setChannels(int channels);
     
     // Get current parameters
     CompressorParameters getParameters() const;
     
+    // Processing delay in frames introduced by look-ahead
+    int getLatency() const;
+    
     // Preset compressor types
     void setPreset(const std::string& presetName);
     std::vector<std::string> getAvailablePresets() const;
@@ -44,12 +67,30 @@ public:
     // Reset compressor state
     void reset();
     
-    // Side-chain compression
+    // Side-chain compression from a whole mono signal held by the
+    // compressor, consumed by successive process() calls while enabled.
+    // Streaming callers should use the side-chain process() overload.
+    // Sets the side-chain channel count to 1.
     void setSideChain(const std::vector<float>& sideChain);
     void enableSideChain(bool enable);
     bool isSideChainEnabled() const;
     
-    // Compression metering
+    // Channels of the external side-chain (default 1). Sizes the side-chain
+    // filter and its scratch buffer, so call it while configuring, not
+    // between streamed blocks.
+    void setSideChainChannels(int channels);
+    int getSideChainChannels() const;
+    
+    // Optional filter on the side-chain before detection, e.g. a high-pass
+    // so bass does not trigger ducking. Design it through the returned
+    // reference; its channel count is set by setSideChainChannels.
+    signal::Filter& getSideChainFilter();
+    void enableSideChainFilter(bool enable);
+    bool isSideChainFilterEnabled() const;
+    
+    // Compression metering, one value per 256 frames. Safe to call from
+    // another thread while process() runs; history holds the most recent
+    // 1024 values.
     double getCurrentGainReduction() const;
     double getAverageGainReduction() const;
     std::vector<double> getGainReductionHistory() const;
@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <string>
+#include <memory>
+#include <cstddef>
 
 namespace song_processor {
 namespace effects {
@@ -12,6 +14,7 @@ struct EchoParameters {
     double wetLevel = 0.5;     // Wet signal level (0.0 to 1.0)
     double dryLevel = 0.7;     // Dry signal level (0.0 to 1.0)
     int sampleRate = 44100;
+    int channels = 1;          // Interleaved channels per frame
 };
 
 class Echo {
@@ -22,6 +25,11 @@ public:
     // Apply echo effect
     std::vector<float> apply(const std::vector<float>& input);
     
+    // Process a block of interleaved frames. State carries over between
+    // calls, so a signal may be fed in blocks of any size. input and
+    // output may point to the same buffer.
+    void process(const float* input, float* output, size_t frames);
+    
     // Set echo parameters
     void setParameters(const EchoParameters& params);
     void setDelay(double delay);
@@ -29,6 +37,7 @@ public:
     void setWetLevel(double wetLevel);
     void setDryLevel(double dryLevel);
     void setSampleRate(int sampleRate);
+    void setChannels(int channels);
     
     // Get current parameters
     EchoParameters getParameters() const;
@@ -40,8 +49,12 @@ public:
     // Reset echo state
     void reset();
     
-    // Multi-tap echo
+    // Multi-tap echo. All taps read from the same delay line as the
+    // feedback path. Delays are fractional, and a small change glides the
+    // read position across the next block rather than jumping, so delays
+    // can be modulated between blocks without clicks.
     void addTap(double delay, double level);
+    void setTap(size_t index, double delay, double level);
     void clearTaps();
     std::vector<std::pair<double, double>> getTaps() const;
 
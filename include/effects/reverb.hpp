@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <string>
+#include <memory>
+#include <cstddef>
 
 namespace song_processor {
 namespace effects {
@@ -13,16 +15,25 @@ struct ReverbParameters {
     double dryLevel = 0.4;      // 0.0 to 1.0
     double width = 1.0;         // 0.0 to 1.0
     int sampleRate = 44100;
+    int channels = 1;           // 1 (mono) or 2 (stereo)
 };
 
 class Reverb {
 public:
+    // Mono or stereo; setChannels clamps to this
+    static constexpr int MAX_CHANNELS = 2;
+    
     Reverb();
     ~Reverb();
     
     // Apply reverb effect
     std::vector<float> apply(const std::vector<float>& input);
     
+    // Process a block of interleaved frames. State carries over between
+    // calls, so a signal may be fed in blocks of any size. input and
+    // output may point to the same buffer.
+    void process(const float* input, float* output, size_t frames);
+    
     // Set reverb parameters
     void setParameters(const ReverbParameters& params);
     void setRoomSize(double roomSize);
@@ -31,10 +42,23 @@ public:
     void setDryLevel(double dryLevel);
     void setWidth(double width);
     void setSampleRate(int sampleRate);
+    void setChannels(int channels);
     
     // Get current parameters
     ReverbParameters getParameters() const;
     
+    // Impulse-response mode: convolve with a measured room response instead
+    // of running the algorithmic network. The IR must share the reverb's
+    // sample rate. roomSize and damping are ignored while an IR is loaded;
+    // wetLevel, dryLevel and width still apply.
+    void loadImpulseResponse(const std::string& filename);
+    void setImpulseResponse(const std::vector<float>& impulseResponse, int irChannels = 1);
+    void clearImpulseResponse();
+    bool hasImpulseResponse() const;
+    
+    // Processing delay in frames (non-zero only in impulse-response mode)
+    int getLatency() const;
+    
     // Preset reverb types
     void setPreset(const std::string& presetName);
     std::vector<std::string> getAvailablePresets() const;
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "audio/audio_loader.hpp"
+#include "audio/audio_view.hpp"
+#include "utils/audio_utils.hpp"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace song_processor {
+namespace processing {
+
+struct BatchJob {
+    std::string inputFile;
+    std::string outputFile;  // Empty to skip writing
+};
+
+// Outcome and timing of one job. Stage times are wall-clock seconds on
+// the worker that ran the job.
+struct BatchJobResult {
+    std::string inputFile;
+    std::string outputFile;
+    bool success = false;
+    std::string error;
+
+    int sampleRate = 0;
+    int channels = 0;
+    size_t frames = 0;
+    size_t memoryBytes = 0;       // Charged against the memory budget
+
+    double budgetWaitSeconds = 0.0;   // Run start to admission: waiting for a worker or memory
+    double loadSeconds = 0.0;
+    double processSeconds = 0.0;
+    double analysisSeconds = 0.0;
+    double writeSeconds = 0.0;
+
+    utils::AudioStatistics statistics;  // Of the processed audio, if enabled
+
+    double getAudioSeconds() const;
+    double getWorkSeconds() const;      // All stages, excluding budget waits
+    double getRealtimeFactor() const;   // Audio seconds per work second
+};
+
+// Runs load -> process -> analyse -> write for a list of files on a
+// work-stealing thread pool. A global memory budget bounds the decoded
+// audio held at once: each job's decoded size is read from its file header
+// up front, and a job is handed to a worker only once a worker is free and
+// the job fits, so workers never wait on memory. Jobs start in order, but
+// when a long track does not fit yet, later tracks that do may go ahead of
+// it a bounded number of times before it is given the memory as it drains.
+// A track larger than the whole budget runs on its own.
+class BatchProcessor {
+public:
+    // Called concurrently from worker threads with a decoded track to
+    // modify in place; each call must use its own effect instances
+    using TrackProcessor = std::function<void(audio::AudioData&)>;
+
+    // Called as each job finishes, one call at a time
+    using ProgressCallback = std::function<void(const BatchJobResult&)>;
+
+    // threads == 0 uses one worker per hardware thread
+    explicit BatchProcessor(size_t threads = 0);
+    ~BatchProcessor();
+
+    void setProcessor(TrackProcessor processor);
+    void setProgressCallback(ProgressCallback callback);
+
+    // Bytes of decoded float audio allowed in flight (default 1 GiB).
+    // Processors that build extra copies of a track need headroom on top.
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const;
+
+    void setOutputFormat(audio::SampleFormat format);
+    void setDither(bool enabled);
+    void setAnalysisEnabled(bool enabled);
+
+    // Process every job and return results in job order. Failures are
+    // reported per job rather than thrown.
+    std::vector<BatchJobResult> run(const std::vector<BatchJob>& jobs);
+
+    // Highest budget use reached during the last run
+    size_t getPeakMemoryInFlight() const;
+    size_t getThreadCount() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace processing
+} // namespace song_processor
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "audio/audio_buffer.hpp"
+#include "effects/compressor.hpp"
+#include "effects/echo.hpp"
+#include "effects/reverb.hpp"
+#include "signal/filter.hpp"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace song_processor {
+namespace processing {
+
+// Runs a series of effects block by block: every stage processes one small
+// block before the chain moves on to the next, so intermediate audio stays
+// in two cache-resident ping-pong buffers instead of making a full-length
+// pass (and allocation) per effect. Effects are referenced, not owned, and
+// must outlive the chain; adding one sets it to the chain's channel count.
+// A reverb handles at most two channels, so adding one to a wider chain,
+// or widening a chain that holds one, throws std::invalid_argument.
+class ProcessingChain {
+public:
+    // Any block processor taking interleaved frames of the chain's channels
+    using StageFunction = std::function<void(const float* input, float* output, size_t frames)>;
+
+    // blockFrames == 0 picks the default of 512 frames
+    explicit ProcessingChain(int channels = 2, size_t blockFrames = 0);
+    ~ProcessingChain();
+
+    ProcessingChain& add(signal::Filter& filter);
+    ProcessingChain& add(effects::Compressor& compressor);
+    ProcessingChain& add(effects::Echo& echo);
+    ProcessingChain& add(effects::Reverb& reverb);
+    // Custom stage; latency is in frames and reset may be empty
+    ProcessingChain& add(StageFunction stage, int latency = 0, std::function<void()> reset = nullptr);
+
+    void clear();
+
+    // Process interleaved frames; state carries over between calls, so a
+    // signal may be fed in blocks of any size. input and output may point
+    // to the same buffer.
+    void process(const float* input, float* output, size_t frames);
+
+    // Same result as process(), with every stage on its own thread: stage
+    // s works on block k while stage s + 1 works on block k - 1, blocks
+    // passing between them through lock-free single-producer queues. The
+    // slowest stage bounds the speed, so it pays off on long signals with
+    // several heavy stages. Stages after the first run in place on the
+    // block, so custom stages must accept input == output.
+    void processPipelined(const float* input, float* output, size_t frames);
+
+    // Whole signal in, one output allocation
+    std::vector<float> apply(const std::vector<float>& input);
+
+    // Reset every stage's state
+    void reset();
+
+    void setChannels(int channels);
+    int getChannels() const;
+    void setBlockSize(size_t frames);
+    size_t getBlockSize() const;
+    size_t getStageCount() const;
+
+    // Total delay added by the stages, in frames
+    int getLatency() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// Process every channel of a planar buffer in place through its own
+// single-channel chain, channels in parallel on the shared thread pool:
+// chains[c] handles channel c. Suits channel-independent effects (filters,
+// echoes); chains must not share effect instances. With pipelined set, each
+// channel also runs its stages on separate threads. If a channel throws,
+// the first error is rethrown once every channel has finished.
+void processChannels(const std::vector<ProcessingChain*>& chains, audio::AudioBufferView buffer,
+                     bool pipelined = false);
+
+} // namespace processing
+} // namespace song_processor
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace song_processor {
+namespace signal {
+
+// Streaming FFT convolution with a uniformly partitioned impulse response.
+//
+// The impulse response is cut into blockSize partitions whose spectra are
+// computed once. Each block of blockSize input frames is transformed once
+// and pushed into a frequency-domain delay line; the output block is the
+// inverse transform of the sum of delay-line spectra times partition
+// spectra (overlap-save). Latency is exactly one block, independent of the
+// impulse response length.
+class Convolver {
+public:
+    Convolver();
+    ~Convolver();
+
+    // impulseResponse holds frames of irChannels interleaved channels. A
+    // mono response filters every channel; otherwise IR channel c filters
+    // signal channel c. blockSize should be a power of two.
+    void setImpulseResponse(const float* impulseResponse, size_t frames, int irChannels = 1, int blockSize = 512);
+    void setImpulseResponse(const std::vector<float>& impulseResponse, int irChannels = 1, int blockSize = 512);
+    void clear();
+
+    // Convolve a block of interleaved frames. input and output may point
+    // to the same buffer.
+    void process(const float* input, float* output, size_t frames);
+
+    // Clear the delay line and overlap state, keeping the impulse response
+    void reset();
+
+    // Configuration
+    void setChannels(int channels);
+    int getChannels() const;
+    int getBlockSize() const;
+    int getLatency() const;
+    size_t getImpulseResponseLength() const;
+    bool hasImpulseResponse() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace signal
+} // namespace song_processor
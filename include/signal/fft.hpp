@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <complex>
+#include <string>
+#include <memory>
 
 namespace song_processor {
 namespace signal {
@@ -17,7 +19,14 @@ public:
     // Inverse FFT (frequency domain to time domain)
     std::vector<float> inverse(const std::vector<std::complex<double>>& input);
     
-    // Set FFT size
+    // Real-input transforms on caller-owned buffers, without allocation.
+    // forwardReal reads getSize() samples and writes getSize() / 2 + 1 bins;
+    // inverseReal is its exact inverse, including the 1/N scaling.
+    void forwardReal(const float* input, std::complex<double>* output);
+    void inverseReal(const std::complex<double>* input, float* output);
+    
+    // Set FFT size. Any size >= 2 is supported; powers of two are fastest.
+    // Twiddle and permutation tables are built here, once per size.
     void setSize(int size);
     int getSize() const;
     
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "utils/math_utils.hpp"
 #include <vector>
 #include <complex>
+#include <memory>
+#include <cstddef>
 
 namespace song_processor {
 namespace signal {
@@ -14,34 +17,109 @@ enum class FilterType {
     NOTCH
 };
 
+// One second-order section, normalised so that a0 == 1:
+// H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2)
+struct BiquadCoefficients {
+    double b0 = 1.0;
+    double b1 = 0.0;
+    double b2 = 0.0;
+    double a1 = 0.0;
+    double a2 = 0.0;
+};
+
+// Response of a filter on a uniform grid from DC up to, not including,
+// Nyquist
+struct FilterAnalysis {
+    std::vector<double> frequencies;  // Hz
+    std::vector<double> magnitudeDb;
+    std::vector<double> phase;        // Radians, unwrapped
+    std::vector<double> groupDelay;   // Samples
+};
+
 class Filter {
 public:
     Filter();
     ~Filter();
     
-    // Design filters
+    // Design filters. order is clamped to 1..filter_design::MAX_ORDER (16);
+    // band designs round an odd order up, since the band transform doubles
+    // the prototype order. getOrder() reports the order actually built.
     void designLowPass(double cutoffFreq, double sampleRate, int order = 4);
     void designHighPass(double cutoffFreq, double sampleRate, int order = 4);
     void designBandPass(double lowFreq, double highFreq, double sampleRate, int order = 4);
     void designBandStop(double lowFreq, double highFreq, double sampleRate, int order = 4);
     void designNotch(double frequency, double sampleRate, double Q = 10.0);
     
+    // Equiripple low- or high-pass designs; type must be LOW_PASS or
+    // HIGH_PASS. cutoffFreq is the passband edge, where the gain is
+    // -rippleDb.
+    void designChebyshev(FilterType type, double cutoffFreq, double sampleRate, int order = 4, double rippleDb = 1.0);
+    void designElliptic(FilterType type, double cutoffFreq, double sampleRate, int order = 4,
+                        double rippleDb = 1.0, double stopbandDb = 60.0);
+    
+    // Linear-phase FIR designs by the windowed-sinc method. taps is rounded
+    // up to an odd count, so the delay is a whole (taps - 1) / 2 frames.
+    // Kaiser windows use beta 8.6.
+    void designFirLowPass(double cutoffFreq, double sampleRate, int taps = 255,
+                          utils::WindowType window = utils::WindowType::BLACKMAN);
+    void designFirHighPass(double cutoffFreq, double sampleRate, int taps = 255,
+                           utils::WindowType window = utils::WindowType::BLACKMAN);
+    void designFirBandPass(double lowFreq, double highFreq, double sampleRate, int taps = 255,
+                           utils::WindowType window = utils::WindowType::BLACKMAN);
+    void designFirBandStop(double lowFreq, double highFreq, double sampleRate, int taps = 255,
+                           utils::WindowType window = utils::WindowType::BLACKMAN);
+    
+    // Use an externally designed cascade of second-order sections. The
+    // parameter setters below leave it as it is until the next design call.
+    void setSections(const std::vector<BiquadCoefficients>& sections);
+    
+    // Use an externally designed FIR kernel in place of the sections.
+    // Short kernels run as a direct SIMD convolution; longer ones move
+    // every tap past the first block into a partitioned FFT convolver,
+    // with no added latency either way. As with setSections, the parameter
+    // setters leave a kernel set here untouched.
+    void setFirCoefficients(const std::vector<float>& coefficients);
+    
     // Apply filter to audio data
     std::vector<float> apply(const std::vector<float>& input);
     
+    // Filter a block of interleaved frames. State carries over between
+    // calls, so a signal may be fed in blocks of any size. input and
+    // output may point to the same buffer.
+    void process(const float* input, float* output, size_t frames);
+    
+    // Clear filter state
+    void reset();
+    
     // Get frequency response
     std::vector<std::complex<double>> getFrequencyResponse(int numPoints = 1024);
     
-    // Filter parameters
+    // Magnitude, phase and group delay in one pass over the same grid as
+    // getFrequencyResponse. Sections are evaluated in closed form with
+    // their delay derivatives; FIR kernels take one zero-padded FFT.
+    FilterAnalysis analyze(int numPoints = 1024) const;
+    
+    // Filter parameters. They redesign the filter last built by a design
+    // call, and do nothing for sections or a kernel set directly. IIR state
+    // is kept while the section count stays the same, so the cutoff can be
+    // swept block by block without clicks. A windowed-sinc redesign keeps
+    // its state only while the kernel is short enough to run without the
+    // FFT tail (256 taps); longer kernels start from silence on every
+    // change, so sweep those with an IIR design instead.
     void setCutoffFrequency(double freq);
     void setQ(double q);
     void setOrder(int order);
+    void setChannels(int channels);
     
     // Get filter info
     FilterType getType() const;
     double getCutoffFrequency() const;
     double getQ() const;
     int getOrder() const;
+    int getChannels() const;
+    std::vector<BiquadCoefficients> getSections() const;
+    std::vector<float> getFirCoefficients() const;
+    bool isFir() const;
 
 private:
     class Impl;
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace song_processor {
+namespace signal {
+
+enum class ResampleQuality {
+    FAST,     // 16 taps per phase, for previews
+    MEDIUM,   // 48 taps per phase
+    HIGH      // 96 taps per phase, about 100 dB image rejection
+};
+
+// Streaming sample-rate converter for rational ratios. The rate pair is
+// reduced to L/M (44.1k -> 48k is 160/147); a Kaiser-windowed sinc
+// prototype at L times the input rate is split into L polyphase branches,
+// precomputed once, so each output sample is a single short dot product
+// over the input history. Output is aligned with the input: the filter
+// look-ahead appears as getLatency() input frames held back until more
+// input or flush() arrives. Equal rates copy samples through unchanged.
+class Resampler {
+public:
+    // Throws std::invalid_argument for non-positive rates or ratios whose
+    // reduced numerator exceeds 4096 polyphase branches
+    Resampler(int inputRate = 44100, int outputRate = 48000, int channels = 1,
+              ResampleQuality quality = ResampleQuality::HIGH);
+    ~Resampler();
+
+    void setRates(int inputRate, int outputRate);
+    void setChannels(int channels);
+    void setQuality(ResampleQuality quality);
+
+    // Resample interleaved frames; state carries over between calls.
+    // output must hold getMaxOutputFrames(frames) frames. Returns the
+    // number of frames written.
+    size_t process(const float* input, size_t frames, float* output);
+
+    // Finish the stream as if followed by silence, writing the held-back
+    // frames so the total output is ceil(inputFrames * L / M). output must
+    // hold getMaxOutputFrames(getLatency()) frames. Call reset() before
+    // starting another stream.
+    size_t flush(float* output);
+
+    // Whole signal in and out, flushed
+    std::vector<float> apply(const std::vector<float>& input);
+
+    void reset();
+
+    size_t getMaxOutputFrames(size_t inputFrames) const;
+    int getLatency() const;           // Input frames of look-ahead
+    int getInputRate() const;
+    int getOutputRate() const;
+    int getChannels() const;
+    ResampleQuality getQuality() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace signal
+} // namespace song_processor
@@ -3,8 +3,14 @@
 #include <vector>
 #include <complex>
 #include <string>
+#include <memory>
+#include <cstddef>
 
 namespace song_processor {
+namespace utils {
+class ThreadPool;
+}
+
 namespace signal {
 
 struct SpectrumData {
@@ -15,6 +21,20 @@ struct SpectrumData {
     int fftSize;
 };
 
+// Magnitude spectrogram held in one contiguous row-major matrix:
+// numFrames rows of numBins magnitudes, frame k starting at k * hopSize
+struct Spectrogram {
+    std::vector<float> magnitudes;
+    int numFrames = 0;
+    int numBins = 0;
+    int fftSize = 0;
+    int hopSize = 0;
+    double sampleRate = 0.0;
+    
+    const float* frame(int index) const { return magnitudes.data() + static_cast<size_t>(index) * numBins; }
+    float at(int frameIndex, int bin) const { return frame(frameIndex)[bin]; }
+};
+
 class SpectrumAnalyzer {
 public:
     SpectrumAnalyzer();
@@ -23,19 +43,42 @@ public:
     // Analyze audio spectrum
     SpectrumData analyze(const std::vector<float>& input);
     
-    // Real-time spectrum analysis
+    // Batch spectrogram of a whole signal. Frames are split into
+    // contiguous ranges run on a thread pool together with the calling
+    // thread: the process-wide ThreadPool::shared() in numThreads ranges
+    // (0 = one per worker plus the caller), or the given pool. Safe to call
+    // from inside a pool task. The last frame is zero-padded so the entire
+    // input is covered.
+    Spectrogram computeSpectrogram(const std::vector<float>& input, int numThreads = 0);
+    Spectrogram computeSpectrogram(const float* input, size_t length, int numThreads = 0);
+    Spectrogram computeSpectrogram(const float* input, size_t length, utils::ThreadPool& pool);
+    
+    // Real-time spectrum analysis. Input of any chunk size is appended to
+    // an fftSize ring buffer and a new spectrum is computed every hop
+    // samples (hop = fftSize * (1 - overlap)). Returns the number of new
+    // spectra produced by this call.
     void update(const std::vector<float>& input);
+    int update(const float* input, size_t count);
     SpectrumData getCurrentSpectrum() const;
     
+    // Copy the current spectrum into spectrum, reusing its storage
+    void getCurrentSpectrum(SpectrumData& spectrum) const;
+    
     // Configuration
     void setFFTSize(int size);
     void setWindowType(const std::string& windowType);
     void setOverlap(double overlap); // 0.0 to 1.0
+    void setSampleRate(double sampleRate);
+    
+    // Clear the streaming buffer and current spectrum
+    void reset();
     
     // Get analysis parameters
     int getFFTSize() const;
     std::string getWindowType() const;
     double getOverlap() const;
+    double getSampleRate() const;
+    int getHopSize() const;
     
     // Spectrum processing
     std::vector<double> getFrequencyBands(const std::vector<double>& frequencies, int numBands = 10);
@@ -1,22 +1,33 @@
 #pragma once
 
 // Audio processing
+#include "audio/audio_buffer.hpp"
 #include "audio/audio_loader.hpp"
 #include "audio/audio_writer.hpp"
+#include "audio/sample_conversion.hpp"
+#include "audio/wav_stream_writer.hpp"
 
 // Signal processing
 #include "signal/filter.hpp"
 #include "signal/fft.hpp"
 #include "signal/spectrum_analyzer.hpp"
+#include "signal/convolver.hpp"
+#include "signal/resampler.hpp"
 
 // Audio effects
 #include "effects/reverb.hpp"
 #include "effects/echo.hpp"
 #include "effects/compressor.hpp"
 
+// Batch processing
+#include "processing/batch_processor.hpp"
+#include "processing/processing_chain.hpp"
+
 // Utilities
 #include "utils/audio_utils.hpp"
+#include "utils/filter_design.hpp"
 #include "utils/math_utils.hpp"
+#include "utils/thread_pool.hpp"
 
 namespace song_processor {
     // Main namespace for the library
@@ -2,10 +2,63 @@
 
 #include <vector>
 #include <string>
+#include <cstddef>
+#include <cstdint>
 
 namespace song_processor {
 namespace utils {
 
+// Level and validity statistics for one channel. NaN and Inf samples are
+// counted in nonFiniteCount and left out of every other figure.
+struct ChannelStatistics {
+    size_t sampleCount = 0;      // All samples, finite or not
+    size_t nonFiniteCount = 0;   // NaN or Inf samples
+    size_t clipCount = 0;        // Finite samples with |x| > 1
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+    float peak = 0.0f;           // Largest |x|
+    float min = 0.0f;
+    float max = 0.0f;
+
+    double rms() const;
+    double dcOffset() const;
+    double dynamicRange() const; // Peak to RMS ratio in dB
+    bool isValid() const;        // Non-empty and entirely finite
+    bool isClipping() const;
+};
+
+struct AudioStatistics {
+    std::vector<ChannelStatistics> channels;
+
+    // All channels pooled together
+    ChannelStatistics combined() const;
+};
+
+// Fades, normalisation and clip protection folded into one gain curve and
+// applied in a single write pass. The level stages work from the source
+// peak, which is measured with one read pass unless supplied (for example
+// from calculateStatistics); fades then shape that level, so the output
+// never exceeds the normalise target or the clip threshold.
+class GainEnvelope {
+public:
+    GainEnvelope& fadeIn(double durationMs);
+    GainEnvelope& fadeOut(double durationMs);
+    GainEnvelope& normalize(float targetLevel);
+    GainEnvelope& preventClipping(float threshold = 0.99f);
+    GainEnvelope& setSourcePeak(float peak);
+    
+    // input and output may point to the same buffer
+    void apply(const float* input, float* output, size_t frames, int channels, int sampleRate) const;
+    void apply(std::vector<float>& samples, int channels, int sampleRate) const;
+
+private:
+    double fadeInMs = 0.0;
+    double fadeOutMs = 0.0;
+    float normalizeTarget = -1.0f;  // < 0 when not normalising
+    float clipThreshold = -1.0f;    // < 0 when not protecting
+    float sourcePeak = -1.0f;       // < 0 when not yet known
+};
+
 class AudioUtils {
 public:
     // Audio format conversion
@@ -16,10 +69,18 @@ public:
     
     // Audio manipulation
     static std::vector<float> normalize(const std::vector<float>& input, float targetLevel = 0.0f);
-    static std::vector<float> fadeIn(const std::vector<float>& input, double durationMs);
-    static std::vector<float> fadeOut(const std::vector<float>& input, double durationMs);
+    // Fades over whole frames of interleaved channels at the given rate
+    static std::vector<float> fadeIn(const std::vector<float>& input, double durationMs, int sampleRate = 44100, int channels = 1);
+    static std::vector<float> fadeOut(const std::vector<float>& input, double durationMs, int sampleRate = 44100, int channels = 1);
     static std::vector<float> crossfade(const std::vector<float>& input1, const std::vector<float>& input2, double durationMs);
     
+    // Variants writing into caller-owned memory; output may equal input.
+    // Fades work on whole frames of interleaved channels.
+    static void normalize(const float* input, float* output, size_t samples, float targetLevel);
+    static void fadeIn(const float* input, float* output, size_t frames, int channels, double durationMs, int sampleRate);
+    static void fadeOut(const float* input, float* output, size_t frames, int channels, double durationMs, int sampleRate);
+    static void preventClipping(const float* input, float* output, size_t samples, float threshold = 0.99f);
+    
     // Stereo processing
     static std::pair<std::vector<float>, std::vector<float>> splitStereo(const std::vector<float>& stereo);
     static std::vector<float> mergeStereo(const std::vector<float>& left, const std::vector<float>& right);
@@ -32,6 +93,11 @@ public:
     static double calculateDynamicRange(const std::vector<float>& input);
     static std::vector<double> calculateSpectrum(const std::vector<float>& input, int fftSize = 2048);
     
+    // Every statistic above plus DC offset, extremes, clip and NaN/Inf
+    // counts for each channel of interleaved data, in one pass
+    static AudioStatistics calculateStatistics(const float* input, size_t frames, int channels);
+    static AudioStatistics calculateStatistics(const std::vector<float>& input, int channels = 1);
+    
     // Time utilities
     static int samplesToMs(int samples, int sampleRate);
     static int msToSamples(int ms, int sampleRate);
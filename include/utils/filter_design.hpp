@@ -0,0 +1,476 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+
+namespace song_processor {
+namespace utils {
+namespace filter_design {
+
+// IIR designers: analog prototype, low-, high- or band transform, bilinear
+// transform, emitted directly as second-order sections. Everything here is
+// constexpr, so fixed presets can be computed at compile time:
+//
+//     constexpr auto preset = filter_design::butterworth(4, 80.0, 48000.0, true);
+//
+// and the same code runs at run time in a few microseconds, cheap enough
+// to redesign per block while a cutoff is modulated.
+
+constexpr int MAX_ORDER = 16;
+constexpr int MAX_SECTIONS = MAX_ORDER / 2;
+
+// Cascade of second-order sections, six values each laid out as
+// b0 b1 b2 a0 a1 a2 with a0 == 1. An odd order ends in a first-order
+// section with b2 == a2 == 0.
+struct SosDesign {
+    std::array<double, 6 * MAX_SECTIONS> coefficients{};
+    int sections = 0;
+
+    constexpr const double* section(int index) const { return coefficients.data() + 6 * index; }
+    constexpr size_t size() const { return static_cast<size_t>(6 * sections); }
+};
+
+namespace detail {
+
+// Math for constant evaluation; <cmath> is not constexpr in C++17.
+// Accurate to a few ulp over the ranges the designers use.
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double LN2 = 0.69314718055994530942;
+
+constexpr double squareRoot(double x) {
+    if (x <= 0.0) return 0.0;
+    double scale = 1.0;
+    while (x > 4.0) { x *= 0.25; scale *= 2.0; }
+    while (x < 0.25) { x *= 4.0; scale *= 0.5; }
+    // Newton from above decreases monotonically to the root
+    double guess = 2.0;
+    for (int i = 0; i < 64; ++i) {
+        double next = 0.5 * (guess + x / guess);
+        if (next >= guess) break;
+        guess = next;
+    }
+    return guess * scale;
+}
+
+constexpr long long roundToInteger(double x) {
+    return static_cast<long long>(x < 0.0 ? x - 0.5 : x + 0.5);
+}
+
+constexpr double exponential(double x) {
+    const long long n = roundToInteger(x / LN2);
+    const double r = x - static_cast<double>(n) * LN2;
+    double term = 1.0;
+    double sum = 1.0;
+    for (int k = 1; k < 24; ++k) {
+        term *= r / k;
+        sum += term;
+    }
+    for (long long i = 0; i < n; ++i) sum *= 2.0;
+    for (long long i = 0; i > n; --i) sum *= 0.5;
+    return sum;
+}
+
+constexpr double logarithm(double x) {
+    if (x <= 0.0) throw std::domain_error("logarithm of a non-positive value");
+    int exponent = 0;
+    while (x > 1.5) { x *= 0.5; ++exponent; }
+    while (x < 0.75) { x *= 2.0; --exponent; }
+    // log x = 2 atanh((x - 1) / (x + 1))
+    const double t = (x - 1.0) / (x + 1.0);
+    const double t2 = t * t;
+    double power = t;
+    double sum = 0.0;
+    for (int k = 1; k < 60; k += 2) {
+        sum += power / k;
+        power *= t2;
+    }
+    return 2.0 * sum + exponent * LN2;
+}
+
+constexpr double power10(double x) { return exponential(x * logarithm(10.0)); }
+constexpr double sinh(double x) { return 0.5 * (exponential(x) - exponential(-x)); }
+constexpr double cosh(double x) { return 0.5 * (exponential(x) + exponential(-x)); }
+constexpr double asinh(double x) { return logarithm(x + squareRoot(x * x + 1.0)); }
+
+constexpr double sine(double x) {
+    const double r = x - 2.0 * PI * static_cast<double>(roundToInteger(x / (2.0 * PI)));
+    double term = r;
+    double sum = r;
+    for (int k = 1; k < 16; ++k) {
+        term *= -r * r / ((2 * k) * (2 * k + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double cosine(double x) { return sine(x + PI / 2.0); }
+constexpr double tangent(double x) { return sine(x) / cosine(x); }
+
+constexpr double arcTangent(double x) {
+    if (x < 0.0) return -arcTangent(-x);
+    if (x > 1.0) return PI / 2.0 - arcTangent(1.0 / x);
+    // Halve the angle so the series converges quickly
+    const double y = x / (1.0 + squareRoot(1.0 + x * x));
+    const double y2 = y * y;
+    double power = y;
+    double sum = 0.0;
+    for (int k = 0; k < 24; ++k) {
+        sum += ((k & 1) ? -power : power) / (2 * k + 1);
+        power *= y2;
+    }
+    return 2.0 * sum;
+}
+
+constexpr double arcTangent2(double y, double x) {
+    if (x > 0.0) return arcTangent(y / x);
+    if (x < 0.0) return y >= 0.0 ? arcTangent(y / x) + PI : arcTangent(y / x) - PI;
+    return y > 0.0 ? PI / 2.0 : (y < 0.0 ? -PI / 2.0 : 0.0);
+}
+
+struct Complex {
+    double re = 0.0;
+    double im = 0.0;
+
+    constexpr Complex() = default;
+    constexpr Complex(double re, double im = 0.0) : re(re), im(im) {}
+
+    friend constexpr Complex operator+(Complex a, Complex b) { return {a.re + b.re, a.im + b.im}; }
+    friend constexpr Complex operator-(Complex a, Complex b) { return {a.re - b.re, a.im - b.im}; }
+    friend constexpr Complex operator*(Complex a, Complex b) {
+        return {a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re};
+    }
+    friend constexpr Complex operator/(Complex a, Complex b) {
+        const double d = b.re * b.re + b.im * b.im;
+        return {(a.re * b.re + a.im * b.im) / d, (a.im * b.re - a.re * b.im) / d};
+    }
+    constexpr double norm() const { return re * re + im * im; }
+};
+
+constexpr Complex I{0.0, 1.0};
+
+constexpr Complex squareRoot(Complex z) {
+    const double r = squareRoot(z.norm());
+    const double re = squareRoot(0.5 * (r + z.re));
+    const double im = squareRoot(0.5 * (r - z.re));
+    return {re, z.im < 0.0 ? -im : im};
+}
+
+constexpr Complex logarithm(Complex z) { return {0.5 * logarithm(z.norm()), arcTangent2(z.im, z.re)}; }
+constexpr Complex sine(Complex z) { return {sine(z.re) * cosh(z.im), cosine(z.re) * sinh(z.im)}; }
+constexpr Complex cosine(Complex z) { return {cosine(z.re) * cosh(z.im), -sine(z.re) * sinh(z.im)}; }
+constexpr Complex arcCosine(Complex z) { return Complex{0.0, -1.0} * logarithm(z + I * squareRoot(1.0 - z * z)); }
+
+// Jacobi elliptic functions with the argument in units of the quarter
+// period K, by descending Landen transformations (Orfanidis). Moduli near
+// 1 lose precision in 1 - k^2, so the complement is passed in directly.
+constexpr int LANDEN_STEPS = 12;
+
+struct Landen {
+    double v[LANDEN_STEPS] = {};
+};
+
+constexpr Landen landen(double k, double kPrime) {
+    Landen sequence;
+    for (int n = 0; n < LANDEN_STEPS; ++n) {
+        k = (k / (1.0 + kPrime)) * (k / (1.0 + kPrime));
+        kPrime = squareRoot((1.0 - k) * (1.0 + k));
+        sequence.v[n] = k;
+    }
+    return sequence;
+}
+
+constexpr Complex ascend(const Landen& sequence, Complex w) {
+    for (int n = LANDEN_STEPS - 1; n >= 0; --n) {
+        const double v = sequence.v[n];
+        w = (1.0 + v) * w / (1.0 + v * w * w);
+    }
+    return w;
+}
+
+constexpr Complex sn(Complex u, const Landen& sequence) {
+    return ascend(sequence, sine(u * (PI / 2.0)));
+}
+
+constexpr Complex cd(Complex u, const Landen& sequence) {
+    return ascend(sequence, cosine(u * (PI / 2.0)));
+}
+
+// Inverse of cd, then of sn through sn(u) = cd(1 - u)
+constexpr Complex acd(Complex w, double k, const Landen& sequence) {
+    double previous = k;
+    for (int n = 0; n < LANDEN_STEPS; ++n) {
+        w = w / (1.0 + squareRoot(1.0 - w * w * (previous * previous))) * (2.0 / (1.0 + sequence.v[n]));
+        previous = sequence.v[n];
+    }
+    return arcCosine(w) * (2.0 / PI);
+}
+
+constexpr Complex asn(Complex w, double k, const Landen& sequence) { return 1.0 - acd(w, k, sequence); }
+
+constexpr Complex bilinear(Complex s, double sampleRate) {
+    return (2.0 * sampleRate + s) / (2.0 * sampleRate - s);
+}
+
+// Pre-warped analog frequency in rad/s for a band edge in Hz, clamped
+// inside (0, sampleRate / 2)
+constexpr double prewarp(double frequency, double sampleRate) {
+    const double nyquist = sampleRate / 2.0;
+    const double edge = frequency < nyquist * 1e-5 ? nyquist * 1e-5 : (frequency > nyquist * 0.999 ? nyquist * 0.999 : frequency);
+    return 2.0 * sampleRate * tangent(PI * edge / sampleRate);
+}
+
+constexpr double magnitude(Complex z) { return squareRoot(z.norm()); }
+
+constexpr int clampOrder(int order) {
+    return order < 1 ? 1 : (order > MAX_ORDER ? MAX_ORDER : order);
+}
+
+} // namespace detail
+
+// Normalised analog low-pass prototype, passband edge at 1 rad/s. Only
+// poles and zeros with non-negative imaginary part are stored; each pair
+// i becomes one section and an odd order adds the real pole. The
+// prototype does not depend on cutoff or sample rate, so a filter whose
+// cutoff moves keeps it and calls only digitise().
+struct Prototype {
+    detail::Complex poles[MAX_SECTIONS];
+    detail::Complex zeros[MAX_SECTIONS];  // Used when finiteZeros
+    int pairs = 0;
+    bool hasRealPole = false;
+    double realPole = 0.0;
+    bool finiteZeros = false;
+    double passbandGain = 1.0;   // Gain at DC
+};
+
+// order is clamped to [1, MAX_ORDER]. Ripple and stopband attenuation
+// are in dB.
+constexpr Prototype butterworthPrototype(int order) {
+    using namespace detail;
+    order = clampOrder(order);
+    Prototype prototype;
+    prototype.pairs = order / 2;
+    for (int k = 0; k < prototype.pairs; ++k) {
+        const double theta = PI * (2.0 * k + order + 1) / (2.0 * order);
+        prototype.poles[k] = {cosine(theta), sine(theta)};
+    }
+    prototype.hasRealPole = order % 2 == 1;
+    prototype.realPole = -1.0;
+    return prototype;
+}
+
+constexpr Prototype chebyshevPrototype(int order, double rippleDb) {
+    using namespace detail;
+    if (!(rippleDb > 0.0)) throw std::invalid_argument("Chebyshev ripple must be positive");
+    order = clampOrder(order);
+    const double epsilon = squareRoot(power10(rippleDb / 10.0) - 1.0);
+    const double mu = asinh(1.0 / epsilon) / order;
+
+    Prototype prototype;
+    prototype.pairs = order / 2;
+    for (int k = 0; k < prototype.pairs; ++k) {
+        const double theta = PI * (2.0 * k + 1) / (2.0 * order);
+        prototype.poles[k] = {-sinh(mu) * sine(theta), cosh(mu) * cosine(theta)};
+    }
+    prototype.hasRealPole = order % 2 == 1;
+    prototype.realPole = -sinh(mu);
+    // Even orders start the equiripple band at its trough
+    prototype.passbandGain = order % 2 == 0 ? 1.0 / squareRoot(1.0 + epsilon * epsilon) : 1.0;
+    return prototype;
+}
+
+constexpr Prototype ellipticPrototype(int order, double rippleDb, double stopbandDb) {
+    using namespace detail;
+    if (!(rippleDb > 0.0) || !(stopbandDb > rippleDb)) {
+        throw std::invalid_argument("Elliptic design needs 0 < ripple < stopband attenuation");
+    }
+    order = clampOrder(order);
+    const double epsilonPass = squareRoot(power10(rippleDb / 10.0) - 1.0);
+    const double epsilonStop = squareRoot(power10(stopbandDb / 10.0) - 1.0);
+    const double k1 = epsilonPass / epsilonStop;
+    const double k1Prime = squareRoot((1.0 - k1) * (1.0 + k1));
+
+    // Degree equation: the selectivity k reachable at this order
+    const int pairs = order / 2;
+    const Landen complementary = landen(k1Prime, k1);
+    double kPrime = 1.0;
+    for (int i = 0; i < order; ++i) kPrime *= k1Prime;
+    for (int i = 1; i <= pairs; ++i) {
+        const double s = sn(Complex((2.0 * i - 1.0) / order), complementary).re;
+        kPrime *= s * s * s * s;
+    }
+    const double k = squareRoot((1.0 - kPrime) * (1.0 + kPrime));
+
+    // Imaginary shift placing the poles for the requested ripple
+    const double v0 = (asn(I / epsilonPass, k1, landen(k1, k1Prime)) * Complex(0.0, -1.0)).re / order;
+    const Landen selectivity = landen(k, kPrime);
+
+    Prototype prototype;
+    prototype.pairs = pairs;
+    prototype.finiteZeros = true;
+    for (int i = 1; i <= pairs; ++i) {
+        const double u = (2.0 * i - 1.0) / order;
+        const double zero = 1.0 / (k * cd(Complex(u), selectivity).re);
+        prototype.zeros[i - 1] = {0.0, zero};
+
+        detail::Complex pole = I * cd(Complex(u, -v0), selectivity);
+        if (pole.im < 0.0) pole.im = -pole.im;
+        prototype.poles[i - 1] = pole;
+    }
+    prototype.hasRealPole = order % 2 == 1;
+    prototype.realPole = (I * sn(Complex(0.0, v0), selectivity)).re;
+    prototype.passbandGain = order % 2 == 0 ? 1.0 / squareRoot(1.0 + epsilonPass * epsilonPass) : 1.0;
+    return prototype;
+}
+
+// Frequency transform, bilinear transform and section assembly; cutoff is
+// the passband edge, clamped inside (0, sampleRate / 2). Each section has
+// unity gain at DC (low-pass) or Nyquist (high-pass); the prototype's
+// passband gain goes on the first.
+constexpr SosDesign digitise(const Prototype& prototype, double cutoff, double sampleRate, bool highPass) {
+    using namespace detail;
+    if (!(sampleRate > 0.0)) throw std::invalid_argument("Sample rate must be positive");
+    const double omega = prewarp(cutoff, sampleRate);
+    const double reference = highPass ? -1.0 : 1.0; // z at the passband reference
+    const double infiniteZero = highPass ? 1.0 : -1.0;
+
+    auto transform = [&](Complex s) { return highPass ? Complex(omega) / s : s * omega; };
+
+    SosDesign design;
+    auto emit = [&](double b0, double b1, double b2, double a1, double a2) {
+        // Scale the numerator for unity gain at the reference point
+        const double gain = (1.0 + a1 * reference + a2) / (b0 + b1 * reference + b2);
+        double* c = design.coefficients.data() + 6 * design.sections;
+        c[0] = b0 * gain;
+        c[1] = b1 * gain;
+        c[2] = b2 * gain;
+        c[3] = 1.0;
+        c[4] = a1;
+        c[5] = a2;
+        ++design.sections;
+    };
+
+    for (int i = 0; i < prototype.pairs; ++i) {
+        const Complex pole = bilinear(transform(prototype.poles[i]), sampleRate);
+        double b1 = -2.0 * infiniteZero;
+        double b2 = 1.0;
+        if (prototype.finiteZeros) {
+            const Complex zero = bilinear(transform(prototype.zeros[i]), sampleRate);
+            b1 = -2.0 * zero.re;
+            b2 = zero.norm();
+        }
+        emit(1.0, b1, b2, -2.0 * pole.re, pole.norm());
+    }
+    if (prototype.hasRealPole) {
+        const Complex pole = bilinear(transform(Complex(prototype.realPole)), sampleRate);
+        emit(1.0, -infiniteZero, 0.0, -pole.re, 0.0);
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        design.coefficients[i] *= prototype.passbandGain;
+    }
+    return design;
+}
+
+// Band-pass or band-stop between the passband edges lowEdge and highEdge,
+// through the low-pass to band transform and the bilinear transform. The
+// band transform doubles the order: each prototype pair becomes two
+// sections and the real pole one, so the prototype order is at most
+// MAX_ORDER / 2. Band-pass sections have unity gain at the centre
+// frequency, band-stop sections at DC; the prototype's passband gain goes
+// on the first.
+constexpr SosDesign digitiseBand(const Prototype& prototype, double lowEdge, double highEdge, double sampleRate,
+                                 bool bandStop) {
+    using namespace detail;
+    if (!(sampleRate > 0.0)) throw std::invalid_argument("Sample rate must be positive");
+    if (2 * prototype.pairs + (prototype.hasRealPole ? 1 : 0) > MAX_SECTIONS) {
+        throw std::invalid_argument("Band designs need a prototype of at most half the maximum order");
+    }
+    const double w1 = prewarp(lowEdge, sampleRate);
+    const double w2 = prewarp(highEdge, sampleRate);
+    if (!(w2 > w1)) throw std::invalid_argument("Band edges must satisfy low < high");
+    const double w0 = squareRoot(w1 * w2);
+    const double bandwidth = w2 - w1;
+    const double centre = 2.0 * arcTangent(w0 / (2.0 * sampleRate));
+
+    // z^-1 at the reference point, and the numerator of the prototype's
+    // zeros at infinity: DC and Nyquist for band-pass, the centre for
+    // band-stop
+    const Complex reference = bandStop ? Complex(1.0) : Complex(cosine(centre), -sine(centre));
+    const double infiniteB1 = bandStop ? -2.0 * cosine(centre) : 0.0;
+    const double infiniteB2 = bandStop ? 1.0 : -1.0;
+
+    // Each prototype root s maps to the two roots of s'^2 - k s' + w0^2,
+    // with k = s B for band-pass and B / s for band-stop
+    struct Roots { Complex first, second; };
+    auto transform = [&](Complex s) {
+        const Complex k = bandStop ? Complex(bandwidth) / s : s * bandwidth;
+        const Complex root = squareRoot(k * k - 4.0 * w0 * w0);
+        return Roots{(k + root) * 0.5, (k - root) * 0.5};
+    };
+
+    SosDesign design;
+    auto emit = [&](double b1, double b2, double a1, double a2) {
+        // Scale the numerator for unity gain at the reference point
+        const Complex z2 = reference * reference;
+        const double gain = magnitude(1.0 + a1 * reference + a2 * z2) / magnitude(1.0 + b1 * reference + b2 * z2);
+        double* c = design.coefficients.data() + 6 * design.sections;
+        c[0] = gain;
+        c[1] = b1 * gain;
+        c[2] = b2 * gain;
+        c[3] = 1.0;
+        c[4] = a1;
+        c[5] = a2;
+        ++design.sections;
+    };
+
+    for (int i = 0; i < prototype.pairs; ++i) {
+        // A complex pair: each root and its conjugate form a section
+        const Roots poles = transform(prototype.poles[i]);
+        Roots zeros{};
+        if (prototype.finiteZeros) {
+            zeros = transform(prototype.zeros[i]);
+        }
+        for (int half = 0; half < 2; ++half) {
+            const Complex pole = bilinear(half ? poles.second : poles.first, sampleRate);
+            double b1 = infiniteB1;
+            double b2 = infiniteB2;
+            if (prototype.finiteZeros) {
+                const Complex zero = bilinear(half ? zeros.second : zeros.first, sampleRate);
+                b1 = -2.0 * zero.re;
+                b2 = zero.norm();
+            }
+            emit(b1, b2, -2.0 * pole.re, pole.norm());
+        }
+    }
+    if (prototype.hasRealPole) {
+        // A real pole: its two roots form one section
+        const Roots poles = transform(Complex(prototype.realPole));
+        const Complex first = bilinear(poles.first, sampleRate);
+        const Complex second = bilinear(poles.second, sampleRate);
+        emit(infiniteB1, infiniteB2, -(first + second).re, (first * second).re);
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        design.coefficients[i] *= prototype.passbandGain;
+    }
+    return design;
+}
+
+constexpr SosDesign butterworth(int order, double cutoff, double sampleRate, bool highPass = false) {
+    return digitise(butterworthPrototype(order), cutoff, sampleRate, highPass);
+}
+
+constexpr SosDesign chebyshev(int order, double cutoff, double sampleRate, double rippleDb, bool highPass = false) {
+    return digitise(chebyshevPrototype(order, rippleDb), cutoff, sampleRate, highPass);
+}
+
+constexpr SosDesign elliptic(int order, double cutoff, double sampleRate, double rippleDb, double stopbandDb,
+                             bool highPass = false) {
+    return digitise(ellipticPrototype(order, rippleDb, stopbandDb), cutoff, sampleRate, highPass);
+}
+
+} // namespace filter_design
+} // namespace utils
+} // namespace song_processor
@@ -1,12 +1,22 @@
 #pragma once
 
+#include "aligned_allocator.hpp"
 #include <vector>
 #include <complex>
 #include <cmath>
+#include <string>
 
 namespace song_processor {
 namespace utils {
 
+enum class WindowType {
+    RECTANGULAR,
+    HANNING,
+    HAMMING,
+    BLACKMAN,
+    KAISER
+};
+
 class MathUtils {
 public:
     // Mathematical constants
@@ -33,12 +43,26 @@ public:
     static double frequencyToMidi(double frequency);
     static double midiToFrequency(double midiNote);
     
-    // Window functions
+    // Window functions, built fresh on each call
     static std::vector<float> hanningWindow(int size);
     static std::vector<float> hammingWindow(int size);
     static std::vector<float> blackmanWindow(int size);
     static std::vector<float> kaiserWindow(int size, double beta);
     
+    // Shared window table, 64-byte aligned and immutable. Built on first
+    // use and kept for the lifetime of the process; lookups are lock-free
+    // and safe from any thread. parameter is the Kaiser beta. Nothing is
+    // ever freed, so this is for the few fixed sizes of hot paths (analyser
+    // and FIR design); one-off windows of arbitrary size use buildWindow.
+    static const AlignedVector<float>& getWindow(WindowType type, int size, double parameter = 0.0);
+    
+    // Uncached window of any size, owned by the caller
+    static AlignedVector<float> buildWindow(WindowType type, int size, double parameter = 0.0);
+    
+    // Map "hanning", "hamming", "blackman", "kaiser" or "rectangular" to a
+    // WindowType; throws std::invalid_argument for anything else
+    static WindowType parseWindowType(const std::string& name);
+    
     // Statistical functions
     static double mean(const std::vector<double>& data);
     static double variance(const std::vector<double>& data);
@@ -51,7 +75,9 @@ public:
     static std::vector<double> magnitude(const std::vector<std::complex<double>>& complex);
     static std::vector<double> phase(const std::vector<std::complex<double>>& complex);
     
-    // Filter design helpers
+    // Low-pass IIR designs as flat second-order sections, six values per
+    // section (b0 b1 b2 a0 a1 a2, a0 == 1). ripple and stopband are in dB.
+    // See filter_design.hpp for high-pass and compile-time variants.
     static std::vector<double> butterworthCoefficients(int order, double cutoff, double sampleRate);
     static std::vector<double> chebyshevCoefficients(int order, double cutoff, double sampleRate, double ripple);
     static std::vector<double> ellipticCoefficients(int order, double cutoff, double sampleRate, double ripple, double stopband);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace song_processor {
+namespace utils {
+
+// Fixed-size work-stealing thread pool. Every worker owns a task deque:
+// it takes its own newest task first (cache-warm), and when empty steals
+// the oldest task from another worker. Tasks submitted from inside a task
+// go to the submitting worker's deque; others are spread round-robin.
+class ThreadPool {
+public:
+    // threads == 0 uses one worker per hardware thread
+    explicit ThreadPool(size_t threads = 0);
+
+    // Runs every task still queued, then joins the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Run body(i) for every i in [0, count) on the workers and the calling
+    // thread, returning once all have finished. Indices are claimed one at
+    // a time, so the caller can finish alone: calling from inside a task of
+    // the same pool cannot deadlock, and no extra threads are created.
+    // Waits for this call's work only, unlike wait(). Rethrows the first
+    // exception thrown by body, after every claimed index has finished.
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    // Block until all submitted tasks have finished. Rethrows the first
+    // exception escaping a task since the last wait. Must not be called
+    // from inside a task.
+    void wait();
+
+    size_t getThreadCount() const;
+
+    // Process-wide pool with one worker per hardware thread, created on
+    // first use, for library calls that parallelise internally
+    static ThreadPool& shared();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace utils
+} // namespace song_processor
@@ -1,17 +1,39 @@
 #include "song_processor.hpp"
+#include <cmath>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 
-int main() {
+// Generate a one second 440 Hz stereo test tone
+static std::unique_ptr<song_processor::audio::AudioData> makeTestTone() {
+    auto audioData = std::make_unique<song_processor::audio::AudioData>();
+    audioData->sampleRate = 44100;
+    audioData->channels = 2;
+    audioData->bitsPerSample = 16;
+    
+    const int numSamples = 44100;
+    audioData->samples.resize(numSamples * audioData->channels);
+    
+    for (int i = 0; i < numSamples; ++i) {
+        float sample = 0.1f * std::sin(2.0f * static_cast<float>(song_processor::utils::MathUtils::PI) * 440.0f * i / audioData->sampleRate);
+        audioData->samples[i * 2] = sample;     // Left channel
+        audioData->samples[i * 2 + 1] = sample; // Right channel
+    }
+    
+    return audioData;
+}
+
+int main(int argc, char* argv[]) {
     std::cout << "=== Song Processor Library Demo ===" << std::endl;
     
     try {
         // Create audio loader
         song_processor::audio::AudioLoader loader;
         
-        // Load a test audio file (generates a test tone)
-        std::string filename = "test_audio.wav";
-        auto audioData = loader.loadFromFile(filename);
+        // Load the WAV file given on the command line, or fall back to a test tone
+        std::string filename = argc > 1 ? argv[1] : "test tone";
+        auto audioData = argc > 1 ? loader.loadFromFile(filename) : makeTestTone();
         
         if (audioData) {
             std::cout << "Audio loaded successfully!" << std::endl;
@@ -20,19 +42,24 @@ int main() {
             std::cout << "Bits per Sample: " << audioData->bitsPerSample << std::endl;
             std::cout << "Number of Samples: " << audioData->samples.size() << std::endl;
             
-            // Demonstrate audio utilities
+            // Demonstrate audio utilities: every statistic from one pass
             std::cout << "\n--- Audio Analysis ---" << std::endl;
-            double rms = song_processor::utils::AudioUtils::calculateRMS(audioData->samples);
-            double peak = song_processor::utils::AudioUtils::calculatePeak(audioData->samples);
-            double dynamicRange = song_processor::utils::AudioUtils::calculateDynamicRange(audioData->samples);
-            
-            std::cout << "RMS Level: " << rms << std::endl;
-            std::cout << "Peak Level: " << peak << std::endl;
-            std::cout << "Dynamic Range: " << dynamicRange << " dB" << std::endl;
-            
-            // Check for clipping
-            bool isClipping = song_processor::utils::AudioUtils::isClipping(audioData->samples);
-            std::cout << "Is Clipping: " << (isClipping ? "Yes" : "No") << std::endl;
+            auto stats = song_processor::utils::AudioUtils::calculateStatistics(audioData->samples, audioData->channels);
+            auto overall = stats.combined();
+            
+            std::cout << "RMS Level: " << overall.rms() << std::endl;
+            std::cout << "Peak Level: " << overall.peak << std::endl;
+            std::cout << "Dynamic Range: " << overall.dynamicRange() << " dB" << std::endl;
+            std::cout << "Is Clipping: " << (overall.isClipping() ? "Yes" : "No") << std::endl;
+            std::cout << "Valid Samples: " << (overall.isValid() ? "Yes" : "No") << std::endl;
+            
+            for (size_t ch = 0; ch < stats.channels.size(); ++ch) {
+                const auto& channel = stats.channels[ch];
+                std::cout << "Channel " << ch << ": RMS " << channel.rms()
+                          << ", peak " << channel.peak
+                          << ", DC offset " << channel.dcOffset()
+                          << ", clipped samples " << channel.clipCount << std::endl;
+            }
             
             // Demonstrate stereo processing
             std::cout << "\n--- Stereo Processing ---" << std::endl;
@@ -46,10 +73,22 @@ int main() {
             std::cout << "Normalized peak level: " << newPeak << std::endl;
             
             // Demonstrate fade effects
-            auto fadedIn = song_processor::utils::AudioUtils::fadeIn(audioData->samples, 1000.0); // 1 second fade-in
-            auto fadedOut = song_processor::utils::AudioUtils::fadeOut(audioData->samples, 1000.0); // 1 second fade-out
+            auto fadedIn = song_processor::utils::AudioUtils::fadeIn(audioData->samples, 1000.0, audioData->sampleRate, audioData->channels); // 1 second fade-in
+            auto fadedOut = song_processor::utils::AudioUtils::fadeOut(audioData->samples, 1000.0, audioData->sampleRate, audioData->channels); // 1 second fade-out
             std::cout << "Applied fade-in and fade-out effects" << std::endl;
             
+            // Fade, normalise and clip-protect a copy in one write pass,
+            // reusing the peak measured above
+            std::vector<float> mastered(audioData->samples);
+            song_processor::utils::GainEnvelope()
+                .fadeIn(100.0)
+                .fadeOut(500.0)
+                .normalize(0.9f)
+                .preventClipping(0.99f)
+                .setSourcePeak(overall.peak)
+                .apply(mastered, audioData->channels, audioData->sampleRate);
+            std::cout << "Applied gain envelope, peak now " << song_processor::utils::AudioUtils::calculatePeak(mastered) << std::endl;
+            
             // Demonstrate filter functionality
             std::cout << "\n--- Filter Processing ---" << std::endl;
             song_processor::signal::Filter filter;
@@ -0,0 +1,111 @@
+#include "audio/audio_buffer.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace song_processor {
+namespace audio {
+
+namespace {
+
+// Channel stride rounded up to whole cache lines so every channel stays
+// 64-byte aligned
+size_t alignedStride(size_t frames) {
+    constexpr size_t FLOATS_PER_LINE = utils::CACHE_LINE_SIZE / sizeof(float);
+    return (frames + FLOATS_PER_LINE - 1) / FLOATS_PER_LINE * FLOATS_PER_LINE;
+}
+
+} // namespace
+
+AudioBuffer::AudioBuffer(int channels, size_t frames, int sampleRate) : sampleRate(sampleRate) {
+    resize(channels, frames);
+}
+
+AudioBuffer AudioBuffer::fromInterleaved(const float* interleaved, size_t frames, int channels, int sampleRate) {
+    AudioBuffer buffer(channels, frames, sampleRate);
+    buffer.deinterleave(interleaved, 0, frames);
+    return buffer;
+}
+
+void AudioBuffer::resize(int newChannels, size_t newFrames) {
+    if (newChannels < 0) {
+        throw std::invalid_argument("Channel count must not be negative");
+    }
+    channels = newChannels;
+    frames = newFrames;
+    channelStride = alignedStride(newFrames);
+    storage.assign(channelStride * channels, 0.0f);
+}
+
+void AudioBuffer::clear() {
+    std::fill(storage.begin(), storage.end(), 0.0f);
+}
+
+void AudioBuffer::deinterleave(const float* interleaved, size_t startFrame, size_t count) {
+    if (startFrame + count > frames) {
+        throw std::out_of_range("Frame range exceeds audio buffer");
+    }
+    audio::deinterleave(interleaved, view().subView(startFrame, count));
+}
+
+void AudioBuffer::interleave(float* interleaved, size_t startFrame, size_t count) const {
+    if (startFrame + count > frames) {
+        throw std::out_of_range("Frame range exceeds audio buffer");
+    }
+    audio::interleave(view().subView(startFrame, count), interleaved);
+}
+
+std::vector<float> AudioBuffer::toInterleaved() const {
+    std::vector<float> output(frames * channels);
+    interleave(output.data(), 0, frames);
+    return output;
+}
+
+void deinterleave(const float* interleaved, AudioBufferView output) {
+    const size_t channels = static_cast<size_t>(output.getChannels());
+    const size_t frames = output.getFrameCount();
+
+    if (channels == 2) {
+        float* left = output.getChannel(0);
+        float* right = output.getChannel(1);
+        for (size_t i = 0; i < frames; ++i) {
+            left[i] = interleaved[2 * i];
+            right[i] = interleaved[2 * i + 1];
+        }
+        return;
+    }
+
+    // One channel at a time keeps each write stream sequential
+    for (size_t ch = 0; ch < channels; ++ch) {
+        float* dst = output.getChannel(static_cast<int>(ch));
+        const float* src = interleaved + ch;
+        for (size_t i = 0; i < frames; ++i) {
+            dst[i] = src[i * channels];
+        }
+    }
+}
+
+void interleave(ConstAudioBufferView input, float* interleaved) {
+    const size_t channels = static_cast<size_t>(input.getChannels());
+    const size_t frames = input.getFrameCount();
+
+    if (channels == 2) {
+        const float* left = input.getChannel(0);
+        const float* right = input.getChannel(1);
+        for (size_t i = 0; i < frames; ++i) {
+            interleaved[2 * i] = left[i];
+            interleaved[2 * i + 1] = right[i];
+        }
+        return;
+    }
+
+    for (size_t ch = 0; ch < channels; ++ch) {
+        const float* src = input.getChannel(static_cast<int>(ch));
+        float* dst = interleaved + ch;
+        for (size_t i = 0; i < frames; ++i) {
+            dst[i * channels] = src[i];
+        }
+    }
+}
+
+} // namespace audio
+} // namespace song_processor
@@ -1,4 +1,6 @@
 #include "audio/audio_loader.hpp"
+#include "wav_parser.hpp"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <stdexcept>
@@ -7,38 +9,75 @@ namespace song_processor {
 namespace audio {
 
 struct AudioLoader::Impl {
-    std::vector<std::string> supportedFormats = {"wav", "mp3", "flac", "ogg"};
+    static constexpr size_t BLOCK_FRAMES = 65536;
+    std::vector<std::string> supportedFormats = {"wav", "rf64"};
+    
+    static std::unique_ptr<AudioData> decode(const AudioView& view);
 };
 
+std::unique_ptr<AudioData> AudioLoader::Impl::decode(const AudioView& view) {
+    auto audioData = std::make_unique<AudioData>();
+    audioData->sampleRate = view.getSampleRate();
+    audioData->channels = view.getChannels();
+    audioData->bitsPerSample = view.getBitsPerSample();
+    audioData->samples.resize(view.getFrameCount() * view.getChannels());
+    
+    // Convert straight from the source into the destination, block by block,
+    // so no intermediate copy of the data is ever held
+    float* dst = audioData->samples.data();
+    for (size_t frame = 0; frame < view.getFrameCount(); frame += BLOCK_FRAMES) {
+        size_t read = view.readFrames(frame, dst, BLOCK_FRAMES);
+        dst += read * view.getChannels();
+    }
+    
+    return audioData;
+}
+
 AudioLoader::AudioLoader() : pImpl(std::make_unique<Impl>()) {}
 
 AudioLoader::~AudioLoader() = default;
 
 std::unique_ptr<AudioData> AudioLoader::loadFromFile(const std::string& filename) {
-    // TODO: Implement actual audio file loading
-    // This is a placeholder implementation
-    auto audioData = std::make_unique<AudioData>();
-    audioData->sampleRate = 44100;
-    audioData->channels = 2;
-    audioData->bitsPerSample = 16;
-    
-    // Generate a simple test tone
-    const int numSamples = 44100; // 1 second at 44.1kHz
-    audioData->samples.resize(numSamples * audioData->channels);
-    
-    for (int i = 0; i < numSamples; ++i) {
-        float sample = 0.1f * sin(2.0f * M_PI * 440.0f * i / audioData->sampleRate); // 440 Hz tone
-        audioData->samples[i * 2] = sample;     // Left channel
-        audioData->samples[i * 2 + 1] = sample; // Right channel
-    }
+    MappedAudioFile file(filename);
+    auto audioData = Impl::decode(file.getView());
     
     std::cout << "Loaded audio file: " << filename << std::endl;
     return audioData;
 }
 
+AudioBuffer AudioLoader::loadBuffer(const std::string& filename) {
+    MappedAudioFile file(filename);
+    const AudioView& view = file.getView();
+    
+    AudioBuffer buffer(view.getChannels(), view.getFrameCount(), view.getSampleRate());
+    
+    // Decode a block to interleaved float, then spread it across the
+    // channels; only one block of interleaved samples is ever held
+    std::vector<float> block(Impl::BLOCK_FRAMES * view.getChannels());
+    for (size_t frame = 0; frame < view.getFrameCount(); frame += Impl::BLOCK_FRAMES) {
+        size_t read = view.readFrames(frame, block.data(), Impl::BLOCK_FRAMES);
+        buffer.deinterleave(block.data(), frame, read);
+    }
+    
+    std::cout << "Loaded audio file: " << filename << std::endl;
+    return buffer;
+}
+
+std::unique_ptr<MappedAudioFile> AudioLoader::openFile(const std::string& filename) {
+    return std::make_unique<MappedAudioFile>(filename);
+}
+
+AudioView AudioLoader::openMemory(const uint8_t* data, size_t size) const {
+    WavInfo info = parseWav(data, size);
+    return AudioView(data + info.dataOffset, info.frameCount, info.channels, info.sampleRate, info.format);
+}
+
+std::unique_ptr<AudioData> AudioLoader::loadFromMemory(const uint8_t* data, size_t size) {
+    return Impl::decode(openMemory(data, size));
+}
+
 std::unique_ptr<AudioData> AudioLoader::loadFromMemory(const std::vector<uint8_t>& data) {
-    // TODO: Implement memory-based loading
-    throw std::runtime_error("Memory-based loading not implemented yet");
+    return loadFromMemory(data.data(), data.size());
 }
 
 std::vector<std::string> AudioLoader::getSupportedFormats() const {
@@ -0,0 +1,44 @@
+#include "audio/audio_view.hpp"
+#include "audio/sample_conversion.hpp"
+#include <algorithm>
+
+namespace song_processor {
+namespace audio {
+
+AudioView::AudioView(const uint8_t* data, size_t frameCount, int channels, int sampleRate, SampleFormat format)
+    : data(data), frameCount(frameCount), channels(channels), sampleRate(sampleRate), format(format) {}
+
+int AudioView::getBitsPerSample() const {
+    return static_cast<int>(getBytesPerSample(format) * 8);
+}
+
+size_t AudioView::getBytesPerFrame() const {
+    return getBytesPerSample(format) * static_cast<size_t>(channels);
+}
+
+const float* AudioView::getFloatData() const {
+    if (format != SampleFormat::FLOAT32 || data == nullptr) return nullptr;
+    if (reinterpret_cast<uintptr_t>(data) % alignof(float) != 0) return nullptr;
+    return reinterpret_cast<const float*>(data);
+}
+
+size_t AudioView::readFrames(size_t startFrame, float* output, size_t frames) const {
+    if (startFrame >= frameCount) return 0;
+    frames = std::min(frames, frameCount - startFrame);
+
+    const uint8_t* src = data + startFrame * getBytesPerFrame();
+    const size_t count = frames * static_cast<size_t>(channels);
+
+    decodeSamples(src, format, output, count);
+
+    return frames;
+}
+
+AudioView AudioView::subView(size_t startFrame, size_t frames) const {
+    startFrame = std::min(startFrame, frameCount);
+    frames = std::min(frames, frameCount - startFrame);
+    return AudioView(data + startFrame * getBytesPerFrame(), frames, channels, sampleRate, format);
+}
+
+} // namespace audio
+} // namespace song_processor
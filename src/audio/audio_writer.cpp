@@ -1,41 +1,100 @@
 #include "audio/audio_writer.hpp"
+#include "audio/sample_conversion.hpp"
+#include "audio/wav_stream_writer.hpp"
+#include "wav_header.hpp"
+#include <algorithm>
 #include <iostream>
-#include <fstream>
+#include <stdexcept>
 
 namespace song_processor {
 namespace audio {
 
 struct AudioWriter::Impl {
+    // Interleaved frames handed to the stream per write
+    static constexpr size_t BLOCK_FRAMES = 4096;
+    
     std::vector<std::string> supportedFormats = {"wav", "mp3", "flac", "ogg"};
     int quality = 80;
     int bitrate = 320;
+    bool dither = false;
+    
+    static SampleFormat formatFor(const AudioData& audioData);
 };
 
+SampleFormat AudioWriter::Impl::formatFor(const AudioData& audioData) {
+    // Samples are held as float, so 32 bits means a lossless float file
+    switch (audioData.bitsPerSample) {
+        case 16: return SampleFormat::INT16;
+        case 24: return SampleFormat::INT24;
+        case 32: return SampleFormat::FLOAT32;
+    }
+    throw std::invalid_argument("Unsupported bits per sample: " + std::to_string(audioData.bitsPerSample));
+}
+
 AudioWriter::AudioWriter() : pImpl(std::make_unique<Impl>()) {}
 
 AudioWriter::~AudioWriter() = default;
 
 bool AudioWriter::writeToFile(const AudioData& audioData, const std::string& filename) {
-    // TODO: Implement actual audio file writing
-    std::cout << "Writing audio to: " << filename << std::endl;
-    std::cout << "Sample Rate: " << audioData.sampleRate << " Hz" << std::endl;
-    std::cout << "Channels: " << audioData.channels << std::endl;
-    std::cout << "Samples: " << audioData.samples.size() << std::endl;
-    
-    // Placeholder: just create an empty file for now
-    std::ofstream file(filename, std::ios::binary);
-    if (file.is_open()) {
-        file.close();
-        std::cout << "Audio file written successfully!" << std::endl;
-        return true;
+    try {
+        WavStreamWriter stream(filename, audioData.sampleRate, audioData.channels, Impl::formatFor(audioData));
+        stream.setDither(pImpl->dither);
+        
+        const size_t frames = audioData.samples.size() / audioData.channels;
+        const float* samples = audioData.samples.data();
+        for (size_t start = 0; start < frames; start += Impl::BLOCK_FRAMES) {
+            const size_t count = std::min(Impl::BLOCK_FRAMES, frames - start);
+            stream.write(samples + start * audioData.channels, count);
+        }
+        stream.close();
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to write " << filename << ": " << e.what() << std::endl;
+        return false;
     }
     
-    return false;
+    std::cout << "Audio file written: " << filename << std::endl;
+    return true;
+}
+
+bool AudioWriter::writeToFile(const AudioBuffer& buffer, const std::string& filename, SampleFormat format) {
+    try {
+        WavStreamWriter stream(filename, buffer.getSampleRate(), buffer.getChannels(), format);
+        stream.setDither(pImpl->dither);
+        stream.write(buffer.view());
+        stream.close();
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to write " << filename << ": " << e.what() << std::endl;
+        return false;
+    }
+    
+    std::cout << "Audio file written: " << filename << std::endl;
+    return true;
 }
 
 std::vector<uint8_t> AudioWriter::writeToMemory(const AudioData& audioData, const std::string& format) {
-    // TODO: Implement memory-based writing
-    throw std::runtime_error("Memory-based writing not implemented yet");
+    std::string lowerFormat = format;
+    std::transform(lowerFormat.begin(), lowerFormat.end(), lowerFormat.begin(), ::tolower);
+    if (lowerFormat != "wav") {
+        throw std::runtime_error("Memory-based writing supports only WAV, not " + format);
+    }
+    if (audioData.channels < 1) {
+        throw std::invalid_argument("Audio data has no channels");
+    }
+    
+    const SampleFormat sampleFormat = Impl::formatFor(audioData);
+    const size_t frames = audioData.samples.size() / audioData.channels;
+    const size_t samples = frames * audioData.channels;
+    const uint64_t dataBytes = static_cast<uint64_t>(samples) * getBytesPerSample(sampleFormat);
+    
+    // The final size is known up front: allocate once, convert in place
+    std::vector<uint8_t> output(WAV_HEADER_SIZE + dataBytes + wavPaddingBytes(dataBytes));
+    writeWavHeader(output.data(), audioData.sampleRate, audioData.channels, sampleFormat, dataBytes);
+    
+    TpdfDither dither;
+    encodeSamples(audioData.samples.data(), sampleFormat, output.data() + WAV_HEADER_SIZE, samples,
+                  pImpl->dither ? &dither : nullptr);
+    
+    return output;
 }
 
 std::vector<std::string> AudioWriter::getSupportedFormats() const {
@@ -57,5 +116,9 @@ void AudioWriter::setBitrate(int bitrate) {
     pImpl->bitrate = std::max(32, std::min(320, bitrate));
 }
 
+void AudioWriter::setDither(bool enabled) {
+    pImpl->dither = enabled;
+}
+
 } // namespace audio
-} // namespace song_processor 
\ No newline at end of file
+} // namespace song_processor
@@ -0,0 +1,134 @@
+#include "audio/mapped_audio_file.hpp"
+#include "wav_parser.hpp"
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace song_processor {
+namespace audio {
+
+class MappedAudioFile::Impl {
+public:
+    std::string filename;
+    const uint8_t* mapping = nullptr;
+    size_t fileSize = 0;
+    AudioView view;
+
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    void map();
+    void unmap();
+};
+
+void MappedAudioFile::Impl::map() {
+#ifdef _WIN32
+    fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open audio file: " + filename);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(fileHandle, &size)) {
+        throw std::runtime_error("Cannot stat audio file: " + filename);
+    }
+    fileSize = static_cast<size_t>(size.QuadPart);
+    if (fileSize == 0) {
+        throw std::runtime_error("Audio file is empty: " + filename);
+    }
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr) {
+        throw std::runtime_error("Cannot map audio file: " + filename);
+    }
+    mapping = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (mapping == nullptr) {
+        throw std::runtime_error("Cannot map audio file: " + filename);
+    }
+#else
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open audio file: " + filename);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        throw std::runtime_error("Cannot stat audio file: " + filename);
+    }
+    fileSize = static_cast<size_t>(st.st_size);
+    if (fileSize == 0) {
+        throw std::runtime_error("Audio file is empty: " + filename);
+    }
+
+    void* addr = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("Cannot map audio file: " + filename);
+    }
+    mapping = static_cast<const uint8_t*>(addr);
+
+    // Samples are consumed front to back; let the kernel read ahead aggressively
+    ::madvise(addr, fileSize, MADV_SEQUENTIAL);
+#endif
+}
+
+void MappedAudioFile::Impl::unmap() {
+#ifdef _WIN32
+    if (mapping != nullptr) UnmapViewOfFile(mapping);
+    if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+    if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+#else
+    if (mapping != nullptr) ::munmap(const_cast<uint8_t*>(mapping), fileSize);
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+#endif
+    mapping = nullptr;
+}
+
+MappedAudioFile::MappedAudioFile(const std::string& filename) : pImpl(std::make_unique<Impl>()) {
+    pImpl->filename = filename;
+    try {
+        pImpl->map();
+        WavInfo info = parseWav(pImpl->mapping, pImpl->fileSize);
+        pImpl->view = AudioView(pImpl->mapping + info.dataOffset, info.frameCount,
+                                info.channels, info.sampleRate, info.format);
+    } catch (...) {
+        pImpl->unmap();
+        throw;
+    }
+}
+
+MappedAudioFile::~MappedAudioFile() {
+    pImpl->unmap();
+}
+
+const AudioView& MappedAudioFile::getView() const {
+    return pImpl->view;
+}
+
+const std::string& MappedAudioFile::getFilename() const {
+    return pImpl->filename;
+}
+
+size_t MappedAudioFile::getFileSize() const {
+    return pImpl->fileSize;
+}
+
+} // namespace audio
+} // namespace song_processor
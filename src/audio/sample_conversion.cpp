@@ -0,0 +1,360 @@
+#include "audio/sample_conversion.hpp"
+#include "../utils/simd.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace song_processor {
+namespace audio {
+
+using utils::Float4;
+
+namespace {
+
+// Packed formats are unpacked into a block of int32 and converted with the
+// vector kernels below; the block stays in L1 and is large enough that the
+// scalar byte stores have retired before the vector loads reach them
+constexpr size_t BLOCK_SAMPLES = 256;
+
+struct IntegerRange {
+    float scale;  // Full-scale value
+    float low;
+    float high;   // Largest float that still converts inside the range
+};
+
+IntegerRange rangeFor(int bits) {
+    switch (bits) {
+        case 16: return {32768.0f, -32768.0f, 32767.0f};
+        case 24: return {8388608.0f, -8388608.0f, 8388607.0f};
+        case 32: return {2147483648.0f, -2147483648.0f, 2147483520.0f};
+    }
+    throw std::invalid_argument("Integer samples must be 16, 24 or 32 bits");
+}
+
+int bitsFor(SampleFormat format) {
+    return static_cast<int>(getBytesPerSample(format) * 8);
+}
+
+void integerToFloat(const int32_t* input, float* output, size_t count, const IntegerRange& range) {
+    const Float4 gain = Float4::broadcast(1.0f / range.scale);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        (Float4::loadInt32(input + i) * gain).storeU(output + i);
+    }
+    if (i < count) {
+        // Run the tail through the same kernel so it rounds identically
+        int32_t in[4] = {};
+        float out[4];
+        std::copy(input + i, input + count, in);
+        (Float4::loadInt32(in) * gain).storeU(out);
+        std::copy(out, out + (count - i), output + i);
+    }
+}
+
+// Scale to integer units, add dither noise (in LSB) and clamp; NaN maps
+// to silence rather than to either rail
+Float4 quantise(Float4 x, Float4 noise, Float4 gain, Float4 low, Float4 high) {
+    x = select(x == x, x * gain + noise, Float4::zero());
+    return min(max(x, low), high);
+}
+
+void floatToInteger(const float* input, int32_t* output, size_t count, const IntegerRange& range,
+                    const float* noise) {
+    const Float4 gain = Float4::broadcast(range.scale);
+    const Float4 low = Float4::broadcast(range.low);
+    const Float4 high = Float4::broadcast(range.high);
+
+    size_t i = 0;
+    if (noise) {
+        for (; i + 4 <= count; i += 4) {
+            quantise(Float4::loadU(input + i), Float4::loadU(noise + i), gain, low, high).storeInt32(output + i);
+        }
+    } else {
+        for (; i + 4 <= count; i += 4) {
+            quantise(Float4::loadU(input + i), Float4::zero(), gain, low, high).storeInt32(output + i);
+        }
+    }
+    if (i < count) {
+        float in[4] = {};
+        float tail[4] = {};
+        int32_t out[4];
+        std::copy(input + i, input + count, in);
+        if (noise) {
+            std::copy(noise + i, noise + count, tail);
+        }
+        quantise(Float4::loadU(in), Float4::loadU(tail), gain, low, high).storeInt32(out);
+        std::copy(out, out + (count - i), output + i);
+    }
+}
+
+#if defined(SONG_PROCESSOR_SIMD_SSE)
+// x86 is little-endian, so groups of samples move with single unaligned
+// loads and stores and are rearranged in registers. Each helper returns how
+// many samples it handled; the portable loops finish the rest.
+
+size_t unpackInt16Sse(const uint8_t* src, int32_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+        // Place each sample in the top half of a lane, then sign-extend down
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(_mm_setzero_si128(), x), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(_mm_setzero_si128(), x), 16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), hi);
+    }
+    return i;
+}
+
+size_t unpackInt24Sse(const uint8_t* src, int32_t* dst, size_t count) {
+    size_t i = 0;
+    // A 16-byte load covers four samples plus four spare bytes, which must
+    // still be inside the input
+    for (; i + 6 <= count; i += 4) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+        // Shift each sample's bytes to the start of a register, keep lane 0
+        // of each and move the 24 bits to the top of the lane
+        const __m128i s0 = _mm_slli_epi32(x, 8);
+        const __m128i s1 = _mm_slli_epi32(_mm_srli_si128(x, 3), 8);
+        const __m128i s2 = _mm_slli_epi32(_mm_srli_si128(x, 6), 8);
+        const __m128i s3 = _mm_slli_epi32(_mm_srli_si128(x, 9), 8);
+        const __m128i packed = _mm_unpacklo_epi64(_mm_unpacklo_epi32(s0, s1), _mm_unpacklo_epi32(s2, s3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_srai_epi32(packed, 8));
+    }
+    return i;
+}
+
+size_t packInt16Sse(const int32_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), _mm_packs_epi32(lo, hi));
+    }
+    return i;
+}
+
+size_t packInt24Sse(const int32_t* src, uint8_t* dst, size_t count) {
+    const __m128i lane0 = _mm_setr_epi32(0x00FFFFFF, 0, 0, 0);
+    const __m128i lane1 = _mm_setr_epi32(0, 0x00FFFFFF, 0, 0);
+    const __m128i lane2 = _mm_setr_epi32(0, 0, 0x00FFFFFF, 0);
+    const __m128i lane3 = _mm_setr_epi32(0, 0, 0, 0x00FFFFFF);
+
+    size_t i = 0;
+    // Each 16-byte store writes four spare bytes that the next group
+    // overwrites, so the last group is left to the portable loop
+    for (; i + 6 <= count; i += 4) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i packed = _mm_and_si128(x, lane0);
+        packed = _mm_or_si128(packed, _mm_srli_si128(_mm_and_si128(x, lane1), 1));
+        packed = _mm_or_si128(packed, _mm_srli_si128(_mm_and_si128(x, lane2), 2));
+        packed = _mm_or_si128(packed, _mm_srli_si128(_mm_and_si128(x, lane3), 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 3), packed);
+    }
+    return i;
+}
+#endif
+
+// Samples are little-endian in WAV; assemble them byte-wise so that
+// unaligned data and big-endian hosts are handled the same way.
+void unpack(const uint8_t* src, SampleFormat format, int32_t* dst, size_t count) {
+    size_t i = 0;
+    switch (format) {
+        case SampleFormat::INT16:
+#if defined(SONG_PROCESSOR_SIMD_SSE)
+            i = unpackInt16Sse(src, dst, count);
+#endif
+            for (; i < count; ++i) {
+                const uint8_t* s = src + i * 2;
+                dst[i] = static_cast<int16_t>(s[0] | (s[1] << 8));
+            }
+            break;
+        case SampleFormat::INT24:
+#if defined(SONG_PROCESSOR_SIMD_SSE)
+            i = unpackInt24Sse(src, dst, count);
+#endif
+            for (; i < count; ++i) {
+                const uint8_t* s = src + i * 3;
+                dst[i] = static_cast<int32_t>(static_cast<uint32_t>(s[0]) << 8 |
+                                              static_cast<uint32_t>(s[1]) << 16 |
+                                              static_cast<uint32_t>(s[2]) << 24) >> 8;
+            }
+            break;
+        default:
+#if defined(SONG_PROCESSOR_SIMD_SSE)
+            std::memcpy(dst, src, count * sizeof(int32_t));
+            i = count;
+#endif
+            for (; i < count; ++i) {
+                const uint8_t* s = src + i * 4;
+                dst[i] = static_cast<int32_t>(static_cast<uint32_t>(s[0]) |
+                                              static_cast<uint32_t>(s[1]) << 8 |
+                                              static_cast<uint32_t>(s[2]) << 16 |
+                                              static_cast<uint32_t>(s[3]) << 24);
+            }
+            break;
+    }
+}
+
+void pack(const int32_t* src, SampleFormat format, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    switch (format) {
+        case SampleFormat::INT16:
+#if defined(SONG_PROCESSOR_SIMD_SSE)
+            i = packInt16Sse(src, dst, count);
+#endif
+            for (; i < count; ++i) {
+                const uint32_t value = static_cast<uint32_t>(src[i]);
+                dst[i * 2] = static_cast<uint8_t>(value);
+                dst[i * 2 + 1] = static_cast<uint8_t>(value >> 8);
+            }
+            break;
+        case SampleFormat::INT24:
+#if defined(SONG_PROCESSOR_SIMD_SSE)
+            i = packInt24Sse(src, dst, count);
+#endif
+            for (; i < count; ++i) {
+                const uint32_t value = static_cast<uint32_t>(src[i]);
+                dst[i * 3] = static_cast<uint8_t>(value);
+                dst[i * 3 + 1] = static_cast<uint8_t>(value >> 8);
+                dst[i * 3 + 2] = static_cast<uint8_t>(value >> 16);
+            }
+            break;
+        default:
+#if defined(SONG_PROCESSOR_SIMD_SSE)
+            std::memcpy(dst, src, count * sizeof(int32_t));
+            i = count;
+#endif
+            for (; i < count; ++i) {
+                const uint32_t value = static_cast<uint32_t>(src[i]);
+                dst[i * 4] = static_cast<uint8_t>(value);
+                dst[i * 4 + 1] = static_cast<uint8_t>(value >> 8);
+                dst[i * 4 + 2] = static_cast<uint8_t>(value >> 16);
+                dst[i * 4 + 3] = static_cast<uint8_t>(value >> 24);
+            }
+            break;
+    }
+}
+
+} // namespace
+
+TpdfDither::TpdfDither(uint32_t seed) {
+    setSeed(seed);
+}
+
+void TpdfDither::setSeed(uint32_t seed) {
+    // Derive distinct lane states; xorshift never leaves the all-zero state
+    for (int lane = 0; lane < LANES; ++lane) {
+        uint32_t x = seed + 0x9E3779B9u * static_cast<uint32_t>(lane + 1);
+        x = (x ^ (x >> 16)) * 0x85EBCA6Bu;
+        x = (x ^ (x >> 13)) * 0xC2B2AE35u;
+        x ^= x >> 16;
+        state[lane] = x != 0 ? x : 0x9E3779B9u;
+    }
+}
+
+namespace {
+
+inline float tpdfStep(uint32_t& state) {
+    uint32_t x = state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state = x;
+    // Two 16-bit uniforms from one draw; their difference is triangular
+    const int32_t a = static_cast<int32_t>(x >> 16);
+    const int32_t b = static_cast<int32_t>(x & 0xFFFFu);
+    return static_cast<float>(a - b) * (1.0f / 65536.0f);
+}
+
+} // namespace
+
+void TpdfDither::generate(float* noise, size_t count) {
+    uint32_t lanes[LANES];
+    std::copy(state, state + LANES, lanes);
+
+    // Independent lanes let the compiler run the steps side by side
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        for (int lane = 0; lane < LANES; ++lane) {
+            noise[i + lane] = tpdfStep(lanes[lane]);
+        }
+    }
+    for (int lane = 0; i < count; ++i, ++lane) {
+        noise[i] = tpdfStep(lanes[lane]);
+    }
+
+    std::copy(lanes, lanes + LANES, state);
+}
+
+size_t getBytesPerSample(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::INT16: return 2;
+        case SampleFormat::INT24: return 3;
+        case SampleFormat::INT32: return 4;
+        case SampleFormat::FLOAT32: return 4;
+    }
+    return 0;
+}
+
+void decodeSamples(const uint8_t* input, SampleFormat format, float* output, size_t count) {
+    if (count == 0) return;
+    if (format == SampleFormat::FLOAT32) {
+        std::memcpy(output, input, count * sizeof(float));
+        return;
+    }
+
+    const IntegerRange range = rangeFor(bitsFor(format));
+    const size_t stride = getBytesPerSample(format);
+    int32_t block[BLOCK_SAMPLES];
+
+    for (size_t start = 0; start < count; start += BLOCK_SAMPLES) {
+        const size_t n = std::min(BLOCK_SAMPLES, count - start);
+        unpack(input + start * stride, format, block, n);
+        integerToFloat(block, output + start, n, range);
+    }
+}
+
+void encodeSamples(const float* input, SampleFormat format, uint8_t* output, size_t count, TpdfDither* dither) {
+    if (count == 0) return;
+    if (format == SampleFormat::FLOAT32) {
+        std::memcpy(output, input, count * sizeof(float));
+        return;
+    }
+
+    const IntegerRange range = rangeFor(bitsFor(format));
+    const size_t stride = getBytesPerSample(format);
+    int32_t block[BLOCK_SAMPLES];
+    float noise[BLOCK_SAMPLES];
+
+    for (size_t start = 0; start < count; start += BLOCK_SAMPLES) {
+        const size_t n = std::min(BLOCK_SAMPLES, count - start);
+        if (dither) {
+            dither->generate(noise, n);
+        }
+        floatToInteger(input + start, block, n, range, dither ? noise : nullptr);
+        pack(block, format, output + start * stride, n);
+    }
+}
+
+void decodeSamples(const int32_t* input, int bits, float* output, size_t count) {
+    integerToFloat(input, output, count, rangeFor(bits));
+}
+
+void encodeSamples(const float* input, int bits, int32_t* output, size_t count, TpdfDither* dither) {
+    const IntegerRange range = rangeFor(bits);
+    if (!dither) {
+        floatToInteger(input, output, count, range, nullptr);
+        return;
+    }
+
+    float noise[BLOCK_SAMPLES];
+    for (size_t start = 0; start < count; start += BLOCK_SAMPLES) {
+        const size_t n = std::min(BLOCK_SAMPLES, count - start);
+        dither->generate(noise, n);
+        floatToInteger(input + start, output + start, n, range, noise);
+    }
+}
+
+} // namespace audio
+} // namespace song_processor
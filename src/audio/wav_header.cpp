@@ -0,0 +1,71 @@
+#include "wav_header.hpp"
+#include "audio/sample_conversion.hpp"
+#include <cstring>
+
+namespace song_processor {
+namespace audio {
+
+namespace {
+
+constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+constexpr uint32_t RF64_SIZE_MARKER = 0xFFFFFFFF;
+constexpr uint32_t DS64_CHUNK_SIZE = 28;
+
+void writeU16(uint8_t* p, uint16_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void writeU32(uint8_t* p, uint32_t value) {
+    writeU16(p, static_cast<uint16_t>(value));
+    writeU16(p + 2, static_cast<uint16_t>(value >> 16));
+}
+
+void writeU64(uint8_t* p, uint64_t value) {
+    writeU32(p, static_cast<uint32_t>(value));
+    writeU32(p + 4, static_cast<uint32_t>(value >> 32));
+}
+
+void writeId(uint8_t* p, const char* id) {
+    std::memcpy(p, id, 4);
+}
+
+} // namespace
+
+void writeWavHeader(uint8_t* header, int sampleRate, int channels, SampleFormat format, uint64_t dataBytes) {
+    const uint32_t bytesPerSample = static_cast<uint32_t>(getBytesPerSample(format));
+    const uint32_t blockAlign = bytesPerSample * static_cast<uint32_t>(channels);
+    const uint64_t riffSize = WAV_HEADER_SIZE - 8 + dataBytes + wavPaddingBytes(dataBytes);
+    const bool isRF64 = riffSize > RF64_SIZE_MARKER - 1;
+
+    std::memset(header, 0, WAV_HEADER_SIZE);
+
+    writeId(header, isRF64 ? "RF64" : "RIFF");
+    writeU32(header + 4, isRF64 ? RF64_SIZE_MARKER : static_cast<uint32_t>(riffSize));
+    writeId(header + 8, "WAVE");
+
+    writeId(header + 12, isRF64 ? "ds64" : "JUNK");
+    writeU32(header + 16, DS64_CHUNK_SIZE);
+    if (isRF64) {
+        writeU64(header + 20, riffSize);
+        writeU64(header + 28, dataBytes);
+        writeU64(header + 36, blockAlign != 0 ? dataBytes / blockAlign : 0);
+        // header + 44: table length, left at zero
+    }
+
+    writeId(header + 48, "fmt ");
+    writeU32(header + 52, 16);
+    writeU16(header + 56, format == SampleFormat::FLOAT32 ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM);
+    writeU16(header + 58, static_cast<uint16_t>(channels));
+    writeU32(header + 60, static_cast<uint32_t>(sampleRate));
+    writeU32(header + 64, static_cast<uint32_t>(sampleRate) * blockAlign);
+    writeU16(header + 68, static_cast<uint16_t>(blockAlign));
+    writeU16(header + 70, static_cast<uint16_t>(bytesPerSample * 8));
+
+    writeId(header + 72, "data");
+    writeU32(header + 76, isRF64 ? RF64_SIZE_MARKER : static_cast<uint32_t>(dataBytes));
+}
+
+} // namespace audio
+} // namespace song_processor
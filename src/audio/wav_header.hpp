@@ -0,0 +1,26 @@
+#pragma once
+
+#include "audio/audio_view.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace song_processor {
+namespace audio {
+
+// Bytes written by writeWavHeader; sample data starts at this offset
+constexpr size_t WAV_HEADER_SIZE = 80;
+
+// Write a WAVE header for dataBytes of sample data into header, which must
+// hold WAV_HEADER_SIZE bytes. A 28-byte JUNK chunk is always reserved after
+// the RIFF header; when the file would exceed the 4 GiB RIFF limit it is
+// written as RF64 and that space becomes the ds64 chunk, so the layout
+// never changes when sizes are patched at the end of a stream.
+void writeWavHeader(uint8_t* header, int sampleRate, int channels, SampleFormat format, uint64_t dataBytes);
+
+// Bytes following the sample data: RIFF chunks are padded to even length
+inline size_t wavPaddingBytes(uint64_t dataBytes) {
+    return static_cast<size_t>(dataBytes & 1);
+}
+
+} // namespace audio
+} // namespace song_processor
@@ -0,0 +1,146 @@
+#include "wav_parser.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace song_processor {
+namespace audio {
+
+namespace {
+
+constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+constexpr uint32_t RF64_SIZE_MARKER = 0xFFFFFFFF;
+
+uint16_t readU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t readU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t readU64(const uint8_t* p) {
+    return static_cast<uint64_t>(readU32(p)) | (static_cast<uint64_t>(readU32(p + 4)) << 32);
+}
+
+bool chunkIs(const uint8_t* p, const char* id) {
+    return std::memcmp(p, id, 4) == 0;
+}
+
+SampleFormat toSampleFormat(uint16_t formatTag, int bitsPerSample) {
+    if (formatTag == WAVE_FORMAT_PCM) {
+        switch (bitsPerSample) {
+            case 16: return SampleFormat::INT16;
+            case 24: return SampleFormat::INT24;
+            case 32: return SampleFormat::INT32;
+        }
+    } else if (formatTag == WAVE_FORMAT_IEEE_FLOAT && bitsPerSample == 32) {
+        return SampleFormat::FLOAT32;
+    }
+    throw std::runtime_error("Unsupported WAV sample format: tag " + std::to_string(formatTag) +
+                             ", " + std::to_string(bitsPerSample) + " bits");
+}
+
+} // namespace
+
+WavInfo parseWav(const uint8_t* data, size_t size) {
+    if (data == nullptr || size < 12) {
+        throw std::runtime_error("WAV data too short");
+    }
+
+    WavInfo info;
+    if (chunkIs(data, "RF64")) {
+        info.isRF64 = true;
+    } else if (!chunkIs(data, "RIFF")) {
+        throw std::runtime_error("Not a RIFF/RF64 file");
+    }
+    if (!chunkIs(data + 8, "WAVE")) {
+        throw std::runtime_error("Not a WAVE file");
+    }
+
+    uint64_t ds64DataSize = 0;
+    bool haveFormat = false;
+    bool haveData = false;
+    uint64_t dataSize = 0;
+    size_t blockAlign = 0;
+    size_t pos = 12;
+
+    while (pos + 8 <= size && !(haveFormat && haveData)) {
+        const uint8_t* chunk = data + pos;
+        uint64_t chunkSize = readU32(chunk + 4);
+        const uint8_t* body = chunk + 8;
+        size_t available = size - pos - 8;
+
+        if (chunkIs(chunk, "ds64")) {
+            if (chunkSize < 24 || available < 24) {
+                throw std::runtime_error("Malformed ds64 chunk");
+            }
+            ds64DataSize = readU64(body + 8);
+        } else if (chunkIs(chunk, "fmt ")) {
+            if (chunkSize < 16 || available < 16) {
+                throw std::runtime_error("Malformed fmt chunk");
+            }
+            uint16_t formatTag = readU16(body);
+            info.channels = readU16(body + 2);
+            info.sampleRate = static_cast<int>(readU32(body + 4));
+            blockAlign = readU16(body + 12);
+            int bitsPerSample = readU16(body + 14);
+
+            if (formatTag == WAVE_FORMAT_EXTENSIBLE) {
+                if (chunkSize < 40 || available < 40) {
+                    throw std::runtime_error("Malformed WAVE_FORMAT_EXTENSIBLE header");
+                }
+                // The first two bytes of the sub-format GUID carry the real tag
+                formatTag = readU16(body + 24);
+            }
+
+            info.format = toSampleFormat(formatTag, bitsPerSample);
+            if (info.channels <= 0 || info.sampleRate <= 0 ||
+                blockAlign != static_cast<size_t>(info.channels) * (bitsPerSample / 8)) {
+                throw std::runtime_error("Inconsistent WAV fmt chunk");
+            }
+            haveFormat = true;
+        } else if (chunkIs(chunk, "data")) {
+            info.dataOffset = pos + 8;
+            if (info.isRF64 && chunkSize == RF64_SIZE_MARKER) {
+                dataSize = ds64DataSize;
+            } else if (chunkSize == RF64_SIZE_MARKER) {
+                // Unfinalized streaming header: use whatever follows
+                dataSize = available;
+            } else {
+                dataSize = chunkSize;
+            }
+            haveData = true;
+            if (!haveFormat) {
+                // fmt after data is legal; keep scanning past the sample bytes
+                chunkSize = dataSize;
+            }
+        }
+
+        // Chunks are padded to an even number of bytes
+        uint64_t advance = 8 + chunkSize + (chunkSize & 1);
+        if (advance > size - pos) break;
+        pos += static_cast<size_t>(advance);
+    }
+
+    if (!haveFormat) {
+        throw std::runtime_error("WAV file has no fmt chunk");
+    }
+    if (!haveData) {
+        throw std::runtime_error("WAV file has no data chunk");
+    }
+
+    // Tolerate truncated files by exposing only the frames actually present
+    uint64_t availableData = size - info.dataOffset;
+    if (dataSize > availableData) {
+        dataSize = availableData;
+    }
+    info.frameCount = static_cast<size_t>(dataSize / blockAlign);
+    return info;
+}
+
+} // namespace audio
+} // namespace song_processor
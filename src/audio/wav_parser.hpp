@@ -0,0 +1,24 @@
+#pragma once
+
+#include "audio/audio_view.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace song_processor {
+namespace audio {
+
+struct WavInfo {
+    int sampleRate = 0;
+    int channels = 0;
+    SampleFormat format = SampleFormat::INT16;
+    size_t dataOffset = 0; // Byte offset of the first sample
+    size_t frameCount = 0;
+    bool isRF64 = false;
+};
+
+// Parse a RIFF/WAVE or RF64 header located at the start of data.
+// Throws std::runtime_error on malformed or unsupported input.
+WavInfo parseWav(const uint8_t* data, size_t size);
+
+} // namespace audio
+} // namespace song_processor
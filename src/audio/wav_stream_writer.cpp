@@ -0,0 +1,175 @@
+#include "audio/wav_stream_writer.hpp"
+#include "audio/sample_conversion.hpp"
+#include "utils/aligned_allocator.hpp"
+#include "wav_header.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace song_processor {
+namespace audio {
+
+struct WavStreamWriter::Impl {
+    // Bytes handed to the file per write; the first chunk also carries the
+    // header so every write starts at a multiple of this size
+    static constexpr size_t CHUNK_BYTES = 1 << 18;
+    // Frames interleaved per step when writing planar blocks
+    static constexpr size_t PLANAR_FRAMES = 1024;
+
+    std::string filename;
+    std::ofstream file;
+    int sampleRate;
+    int channels;
+    SampleFormat format;
+    size_t frameBytes;
+
+    // Sized CHUNK_BYTES plus one frame, so a frame never has to be split
+    // across two chunks during conversion
+    utils::AlignedVector<uint8_t> staging;
+    size_t used = 0;
+    bool flushedAny = false;
+
+    std::vector<float> interleaved;
+    TpdfDither dither;
+    bool ditherEnabled = false;
+    size_t framesWritten = 0;
+
+    void writeBytes(const uint8_t* data, size_t size);
+    void flushChunk();
+};
+
+void WavStreamWriter::Impl::writeBytes(const uint8_t* data, size_t size) {
+    file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    if (!file) {
+        throw std::runtime_error("Failed writing audio file: " + filename);
+    }
+}
+
+void WavStreamWriter::Impl::flushChunk() {
+    writeBytes(staging.data(), CHUNK_BYTES);
+    flushedAny = true;
+    used -= CHUNK_BYTES;
+    std::memmove(staging.data(), staging.data() + CHUNK_BYTES, used);
+}
+
+WavStreamWriter::WavStreamWriter(const std::string& filename, int sampleRate, int channels, SampleFormat format)
+    : pImpl(std::make_unique<Impl>()) {
+    if (channels < 1 || channels > 65535) {
+        throw std::invalid_argument("Channel count must be between 1 and 65535");
+    }
+    if (sampleRate <= 0) {
+        throw std::invalid_argument("Sample rate must be positive");
+    }
+
+    pImpl->filename = filename;
+    pImpl->sampleRate = sampleRate;
+    pImpl->channels = channels;
+    pImpl->format = format;
+    pImpl->frameBytes = getBytesPerSample(format) * static_cast<size_t>(channels);
+
+    // Our chunks are already large; skip the stream's own buffering
+    pImpl->file.rdbuf()->pubsetbuf(nullptr, 0);
+    pImpl->file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!pImpl->file.is_open()) {
+        throw std::runtime_error("Cannot create audio file: " + filename);
+    }
+
+    pImpl->staging.resize(Impl::CHUNK_BYTES + pImpl->frameBytes);
+    writeWavHeader(pImpl->staging.data(), sampleRate, channels, format, 0);
+    pImpl->used = WAV_HEADER_SIZE;
+}
+
+WavStreamWriter::~WavStreamWriter() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void WavStreamWriter::setDither(bool enabled) {
+    pImpl->ditherEnabled = enabled;
+}
+
+void WavStreamWriter::write(const float* interleaved, size_t frames) {
+    if (!isOpen()) {
+        throw std::runtime_error("WAV stream is closed: " + pImpl->filename);
+    }
+
+    TpdfDither* dither = pImpl->ditherEnabled ? &pImpl->dither : nullptr;
+    const size_t channels = static_cast<size_t>(pImpl->channels);
+
+    while (frames > 0) {
+        const size_t room = (pImpl->staging.size() - pImpl->used) / pImpl->frameBytes;
+        const size_t count = std::min(frames, room);
+
+        encodeSamples(interleaved, pImpl->format, pImpl->staging.data() + pImpl->used, count * channels, dither);
+        pImpl->used += count * pImpl->frameBytes;
+        pImpl->framesWritten += count;
+        interleaved += count * channels;
+        frames -= count;
+
+        if (pImpl->used >= Impl::CHUNK_BYTES) {
+            pImpl->flushChunk();
+        }
+    }
+}
+
+void WavStreamWriter::write(ConstAudioBufferView block) {
+    if (block.getChannels() != pImpl->channels) {
+        throw std::invalid_argument("Block channel count does not match the WAV stream");
+    }
+
+    pImpl->interleaved.resize(Impl::PLANAR_FRAMES * pImpl->channels);
+    for (size_t start = 0; start < block.getFrameCount(); start += Impl::PLANAR_FRAMES) {
+        const size_t count = std::min(Impl::PLANAR_FRAMES, block.getFrameCount() - start);
+        interleave(block.subView(start, count), pImpl->interleaved.data());
+        write(pImpl->interleaved.data(), count);
+    }
+}
+
+void WavStreamWriter::close() {
+    if (!isOpen()) return;
+
+    const uint64_t dataBytes = static_cast<uint64_t>(pImpl->framesWritten) * pImpl->frameBytes;
+    const size_t padding = wavPaddingBytes(dataBytes);
+    uint8_t header[WAV_HEADER_SIZE];
+    writeWavHeader(header, pImpl->sampleRate, pImpl->channels, pImpl->format, dataBytes);
+
+    try {
+        // The pad byte always fits: staging holds a spare frame beyond CHUNK_BYTES
+        std::fill(pImpl->staging.data() + pImpl->used, pImpl->staging.data() + pImpl->used + padding, 0);
+        pImpl->used += padding;
+
+        if (!pImpl->flushedAny) {
+            // Everything is still staged, header included: patch it in place
+            std::memcpy(pImpl->staging.data(), header, WAV_HEADER_SIZE);
+            pImpl->writeBytes(pImpl->staging.data(), pImpl->used);
+        } else {
+            pImpl->writeBytes(pImpl->staging.data(), pImpl->used);
+            pImpl->file.seekp(0);
+            pImpl->writeBytes(header, WAV_HEADER_SIZE);
+        }
+    } catch (...) {
+        pImpl->file.close();
+        throw;
+    }
+    pImpl->used = 0;
+
+    pImpl->file.close();
+    if (!pImpl->file) {
+        throw std::runtime_error("Failed closing audio file: " + pImpl->filename);
+    }
+}
+
+bool WavStreamWriter::isOpen() const {
+    return pImpl->file.is_open();
+}
+
+size_t WavStreamWriter::getFramesWritten() const {
+    return pImpl->framesWritten;
+}
+
+} // namespace audio
+} // namespace song_processor
@@ -0,0 +1,438 @@
+#include "effects/compressor.hpp"
+#include "utils/aligned_allocator.hpp"
+#include "utils/math_utils.hpp"
+#include "../utils/history_ring.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace song_processor {
+namespace effects {
+
+using utils::AlignedVector;
+using utils::MathUtils;
+
+namespace {
+
+constexpr float DB_PER_NEPER = 8.685889638f;  // 20 / ln(10)
+constexpr float NEPER_PER_DB = 0.1151292546f; // ln(10) / 20
+constexpr float MIN_LEVEL = 1e-10f;           // -200 dB floor for silence
+
+} // namespace
+
+struct Compressor::Impl {
+    static constexpr size_t BLOCK_FRAMES = 256;
+    static constexpr size_t METER_FRAMES = 256;
+    static constexpr size_t HISTORY_SIZE = 1024;
+    static constexpr double MAX_LOOKAHEAD = 20.0; // ms
+
+    CompressorParameters params;
+
+    // Smoothed gain change in dB (<= 0)
+    float envelope = 0.0f;
+    float attackCoeff = 0.0f;
+    float releaseCoeff = 0.0f;
+
+    // Stored side-chain signal, consumed progressively by process()
+    std::vector<float> sideChain;
+    size_t sideChainPos = 0;
+    bool sideChainEnabled = false;
+
+    // Side-chain filtering into a block-sized scratch buffer, both sized
+    // for sideChainChannels when it is set
+    int sideChainChannels = 1;
+    signal::Filter sideChainFilter;
+    bool sideChainFilterEnabled = false;
+    AlignedVector<float> keyScratch;
+
+    // Look-ahead: the audio path runs through an interleaved power-of-two
+    // delay while the detector sees the undelayed signal, so gain changes
+    // land ahead of the transients that cause them
+    std::vector<float> delayLine;
+    size_t delayMask = 0;
+    size_t delayPos = 0;
+    size_t lookaheadFrames = 0;
+
+    // Per-block detector levels, overwritten in place with the gain
+    AlignedVector<float> gains = AlignedVector<float>(BLOCK_FRAMES, 0.0f);
+
+    // Gain reduction metering: the peak over every METER_FRAMES frames,
+    // published to a fixed-size ring that readers poll without locking
+    utils::HistoryRing<double, HISTORY_SIZE> history;
+    std::atomic<double> currentGainReduction{0.0};
+    double meterPeak = 0.0;
+    size_t meterFrames = 0;
+
+    void run(const float* input, float* output, size_t frames, const float* key, size_t keyChannels);
+    void detect(const float* input, const float* key, size_t keyChannels, size_t frames);
+    void updateCoefficients();
+    void allocateDelayLine();
+    void configureSideChain(int channels);
+    float computeGains(size_t frames);
+    void recordGainReduction(double gainReduction, size_t frames);
+};
+
+Compressor::Compressor() : pImpl(std::make_unique<Impl>()) {
+    pImpl->updateCoefficients();
+    pImpl->allocateDelayLine();
+    pImpl->configureSideChain(1);
+}
+
+Compressor::~Compressor() = default;
+
+std::vector<float> Compressor::apply(const std::vector<float>& input) {
+    std::vector<float> output(input);
+    process(input.data(), output.data(), input.size() / pImpl->params.channels);
+    return output;
+}
+
+void Compressor::process(const float* input, float* output, size_t frames) {
+    auto& impl = *pImpl;
+    const size_t channels = static_cast<size_t>(impl.params.channels);
+
+    // The stored side-chain keys as many frames as it has left
+    if (impl.sideChainEnabled && impl.sideChainPos < impl.sideChain.size()) {
+        size_t keyed = std::min(frames, impl.sideChain.size() - impl.sideChainPos);
+        impl.run(input, output, keyed, impl.sideChain.data() + impl.sideChainPos, 1);
+        impl.sideChainPos += keyed;
+        input += keyed * channels;
+        output += keyed * channels;
+        frames -= keyed;
+    }
+    impl.run(input, output, frames, nullptr, 0);
+}
+
+void Compressor::process(const float* input, float* output, size_t frames,
+                         const float* sideChain, int sideChainChannels) {
+    if (sideChain == nullptr || sideChainChannels < 1) {
+        throw std::invalid_argument("Side-chain block needs data and at least one channel");
+    }
+    if (sideChainChannels != pImpl->sideChainChannels) {
+        throw std::invalid_argument("Side-chain block has " + std::to_string(sideChainChannels) +
+                                    " channels but the compressor is set for " +
+                                    std::to_string(pImpl->sideChainChannels) + "; call setSideChainChannels first");
+    }
+    pImpl->run(input, output, frames, sideChain, static_cast<size_t>(sideChainChannels));
+}
+
+void Compressor::setParameters(const CompressorParameters& params) {
+    pImpl->params = params;
+    pImpl->params.threshold = MathUtils::clamp(params.threshold, -60.0, 0.0);
+    pImpl->params.ratio = MathUtils::clamp(params.ratio, 1.0, 100.0);
+    pImpl->params.attack = MathUtils::clamp(params.attack, 0.01, 1000.0);
+    pImpl->params.release = MathUtils::clamp(params.release, 1.0, 5000.0);
+    pImpl->params.knee = MathUtils::clamp(params.knee, 0.0, 24.0);
+    pImpl->params.makeup = MathUtils::clamp(params.makeup, -24.0, 24.0);
+    pImpl->params.sampleRate = std::max(1, params.sampleRate);
+    pImpl->params.lookahead = MathUtils::clamp(params.lookahead, 0.0, Impl::MAX_LOOKAHEAD);
+    pImpl->params.channels = std::max(1, params.channels);
+    pImpl->updateCoefficients();
+    pImpl->allocateDelayLine();
+}
+
+void Compressor::setThreshold(double threshold) {
+    pImpl->params.threshold = MathUtils::clamp(threshold, -60.0, 0.0);
+}
+
+void Compressor::setRatio(double ratio) {
+    pImpl->params.ratio = MathUtils::clamp(ratio, 1.0, 100.0);
+}
+
+void Compressor::setAttack(double attack) {
+    pImpl->params.attack = MathUtils::clamp(attack, 0.01, 1000.0);
+    pImpl->updateCoefficients();
+}
+
+void Compressor::setRelease(double release) {
+    pImpl->params.release = MathUtils::clamp(release, 1.0, 5000.0);
+    pImpl->updateCoefficients();
+}
+
+void Compressor::setKnee(double knee) {
+    pImpl->params.knee = MathUtils::clamp(knee, 0.0, 24.0);
+}
+
+void Compressor::setMakeupGain(double makeup) {
+    pImpl->params.makeup = MathUtils::clamp(makeup, -24.0, 24.0);
+}
+
+void Compressor::setLookahead(double lookahead) {
+    pImpl->params.lookahead = MathUtils::clamp(lookahead, 0.0, Impl::MAX_LOOKAHEAD);
+    pImpl->allocateDelayLine();
+}
+
+void Compressor::setSampleRate(int sampleRate) {
+    pImpl->params.sampleRate = std::max(1, sampleRate);
+    pImpl->updateCoefficients();
+    pImpl->allocateDelayLine();
+}
+
+void Compressor::setChannels(int channels) {
+    pImpl->params.channels = std::max(1, channels);
+    pImpl->allocateDelayLine();
+}
+
+CompressorParameters Compressor::getParameters() const {
+    return pImpl->params;
+}
+
+int Compressor::getLatency() const {
+    return static_cast<int>(pImpl->lookaheadFrames);
+}
+
+void Compressor::setPreset(const std::string& presetName) {
+    CompressorParameters params = pImpl->params;
+
+    if (presetName == "vocal") {
+        params.threshold = -18.0;
+        params.ratio = 3.0;
+        params.attack = 5.0;
+        params.release = 120.0;
+        params.knee = 6.0;
+        params.makeup = 4.0;
+    } else if (presetName == "drums") {
+        params.threshold = -15.0;
+        params.ratio = 4.0;
+        params.attack = 10.0;
+        params.release = 80.0;
+        params.knee = 3.0;
+        params.makeup = 3.0;
+    } else if (presetName == "bass") {
+        params.threshold = -20.0;
+        params.ratio = 5.0;
+        params.attack = 20.0;
+        params.release = 200.0;
+        params.knee = 6.0;
+        params.makeup = 5.0;
+    } else if (presetName == "mastering") {
+        params.threshold = -10.0;
+        params.ratio = 2.0;
+        params.attack = 30.0;
+        params.release = 250.0;
+        params.knee = 10.0;
+        params.makeup = 2.0;
+    } else if (presetName == "limiter") {
+        params.threshold = -1.0;
+        params.ratio = 100.0;
+        params.attack = 0.1;
+        params.release = 50.0;
+        params.knee = 0.0;
+        params.makeup = 0.0;
+    } else {
+        throw std::invalid_argument("Unknown compressor preset: " + presetName);
+    }
+
+    setParameters(params);
+}
+
+std::vector<std::string> Compressor::getAvailablePresets() const {
+    return {"vocal", "drums", "bass", "mastering", "limiter"};
+}
+
+void Compressor::reset() {
+    pImpl->envelope = 0.0f;
+    pImpl->sideChainPos = 0;
+    pImpl->sideChainFilter.reset();
+    std::fill(pImpl->delayLine.begin(), pImpl->delayLine.end(), 0.0f);
+    pImpl->delayPos = 0;
+    pImpl->meterPeak = 0.0;
+    pImpl->meterFrames = 0;
+    pImpl->currentGainReduction.store(0.0, std::memory_order_relaxed);
+    pImpl->history.clear();
+}
+
+void Compressor::setSideChain(const std::vector<float>& sideChain) {
+    pImpl->sideChain = sideChain;
+    pImpl->sideChainPos = 0;
+    pImpl->configureSideChain(1);
+}
+
+void Compressor::enableSideChain(bool enable) {
+    pImpl->sideChainEnabled = enable;
+}
+
+bool Compressor::isSideChainEnabled() const {
+    return pImpl->sideChainEnabled;
+}
+
+void Compressor::setSideChainChannels(int channels) {
+    pImpl->configureSideChain(std::max(1, channels));
+}
+
+int Compressor::getSideChainChannels() const {
+    return pImpl->sideChainChannels;
+}
+
+signal::Filter& Compressor::getSideChainFilter() {
+    return pImpl->sideChainFilter;
+}
+
+void Compressor::enableSideChainFilter(bool enable) {
+    pImpl->sideChainFilterEnabled = enable;
+}
+
+bool Compressor::isSideChainFilterEnabled() const {
+    return pImpl->sideChainFilterEnabled;
+}
+
+double Compressor::getCurrentGainReduction() const {
+    return pImpl->currentGainReduction.load(std::memory_order_relaxed);
+}
+
+double Compressor::getAverageGainReduction() const {
+    std::vector<double> values = pImpl->history.snapshot();
+    if (values.empty()) return 0.0;
+
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    return sum / values.size();
+}
+
+std::vector<double> Compressor::getGainReductionHistory() const {
+    return pImpl->history.snapshot(); // Oldest first
+}
+
+void Compressor::Impl::run(const float* input, float* output, size_t frames, const float* key, size_t keyChannels) {
+    const size_t channels = static_cast<size_t>(params.channels);
+    float* gainBlock = gains.data();
+    float* delay = delayLine.data();
+
+    // Sized by configureSideChain; only a filter whose channels were
+    // changed directly can disagree with the key here
+    if (key != nullptr && sideChainFilterEnabled &&
+        static_cast<size_t>(sideChainFilter.getChannels()) != keyChannels) {
+        throw std::runtime_error("Side-chain filter has " + std::to_string(sideChainFilter.getChannels()) +
+                                 " channels but the key has " + std::to_string(keyChannels) +
+                                 "; set them with setSideChainChannels");
+    }
+
+    while (frames > 0) {
+        size_t count = std::min(frames, BLOCK_FRAMES);
+
+        detect(input, key, keyChannels, count);
+        float peakReduction = computeGains(count);
+
+        // Audio path through the look-ahead delay. The frame is written
+        // before the delayed one is read, so zero look-ahead passes through.
+        size_t pos = delayPos;
+        for (size_t i = 0; i < count; ++i) {
+            float* slot = delay + pos * channels;
+            const float* delayed = delay + ((pos - lookaheadFrames) & delayMask) * channels;
+            for (size_t ch = 0; ch < channels; ++ch) {
+                slot[ch] = input[i * channels + ch];
+                output[i * channels + ch] = delayed[ch] * gainBlock[i];
+            }
+            pos = (pos + 1) & delayMask;
+        }
+        delayPos = pos;
+
+        recordGainReduction(peakReduction, count);
+        input += count * channels;
+        output += count * channels;
+        if (key != nullptr) key += count * keyChannels;
+        frames -= count;
+    }
+}
+
+void Compressor::Impl::detect(const float* input, const float* key, size_t keyChannels, size_t frames) {
+    // Linked detection: the loudest channel of the key drives the gain for
+    // all channels. Without a side-chain the input is its own key.
+    if (key == nullptr) {
+        key = input;
+        keyChannels = static_cast<size_t>(params.channels);
+    } else if (sideChainFilterEnabled) {
+        sideChainFilter.process(key, keyScratch.data(), frames);
+        key = keyScratch.data();
+    }
+
+    float* levels = gains.data();
+    for (size_t i = 0; i < frames; ++i) {
+        float level = 0.0f;
+        for (size_t ch = 0; ch < keyChannels; ++ch) {
+            level = std::max(level, std::abs(key[i * keyChannels + ch]));
+        }
+        levels[i] = level;
+    }
+}
+
+void Compressor::Impl::configureSideChain(int channels) {
+    sideChainChannels = channels;
+    if (sideChainFilter.getChannels() != channels) {
+        sideChainFilter.setChannels(channels);
+    }
+    keyScratch.assign(BLOCK_FRAMES * static_cast<size_t>(channels), 0.0f);
+}
+
+void Compressor::Impl::updateCoefficients() {
+    // One-pole smoothing reaching ~63% of a step in the given time
+    attackCoeff = static_cast<float>(std::exp(-1000.0 / (params.attack * params.sampleRate)));
+    releaseCoeff = static_cast<float>(std::exp(-1000.0 / (params.release * params.sampleRate)));
+}
+
+void Compressor::Impl::allocateDelayLine() {
+    lookaheadFrames = static_cast<size_t>(std::lround(params.lookahead * params.sampleRate / 1000.0));
+    size_t frames = static_cast<size_t>(MathUtils::nextPowerOfTwo(static_cast<int>(lookaheadFrames) + 1));
+    size_t size = frames * params.channels;
+
+    // Keep the running delay when only the look-ahead length changes
+    if (size != delayLine.size()) {
+        delayLine.assign(size, 0.0f);
+        delayPos = 0;
+    }
+    delayMask = frames - 1;
+}
+
+float Compressor::Impl::computeGains(size_t frames) {
+    const float threshold = static_cast<float>(params.threshold);
+    const float slope = static_cast<float>(1.0 / params.ratio - 1.0);
+    const float knee = std::max(static_cast<float>(params.knee), 1e-3f);
+    const float halfKnee = knee / 2.0f;
+    const float kneeScale = slope / (2.0f * knee);
+    const float makeup = static_cast<float>(params.makeup);
+    float* values = gains.data();
+
+    // Static curve in dB with a quadratic soft knee, branch-free: below the
+    // knee both terms vanish, inside it only the quadratic term counts, and
+    // above it they sum to slope * overshoot
+    for (size_t i = 0; i < frames; ++i) {
+        float levelDb = DB_PER_NEPER * std::log(std::max(values[i], MIN_LEVEL));
+        float overshoot = levelDb - threshold;
+        float x = std::min(std::max(overshoot + halfKnee, 0.0f), knee);
+        values[i] = kneeScale * x * x + slope * std::max(overshoot - halfKnee, 0.0f);
+    }
+
+    // Attack/release smoothing is the only serial step
+    float env = envelope;
+    float deepest = 0.0f;
+    for (size_t i = 0; i < frames; ++i) {
+        float target = values[i];
+        float coeff = target < env ? attackCoeff : releaseCoeff;
+        env = target + coeff * (env - target);
+        deepest = std::min(deepest, env);
+        values[i] = env;
+    }
+    envelope = env;
+
+    for (size_t i = 0; i < frames; ++i) {
+        values[i] = std::exp(NEPER_PER_DB * (values[i] + makeup));
+    }
+    return -deepest;
+}
+
+void Compressor::Impl::recordGainReduction(double gainReduction, size_t frames) {
+    meterPeak = std::max(meterPeak, gainReduction);
+    meterFrames += frames;
+    if (meterFrames >= METER_FRAMES) {
+        history.push(meterPeak);
+        currentGainReduction.store(meterPeak, std::memory_order_relaxed);
+        meterPeak = 0.0;
+        meterFrames = 0;
+    }
+}
+
+} // namespace effects
+} // namespace song_processor
@@ -0,0 +1,337 @@
+#include "effects/echo.hpp"
+#include "utils/math_utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace song_processor {
+namespace effects {
+
+using utils::MathUtils;
+
+namespace {
+
+// Reads one tap over a run of frames with linear interpolation and adds
+// gain * sample to out. The read position starts at frame start + frac
+// and advances by step frames per output frame; the run never wraps
+// because the ring keeps a mirrored guard region past its end.
+void accumulateTap(const float* buffer, size_t channels, size_t start, double frac, double step,
+                   size_t frames, float gain, float* out) {
+    const float* base = buffer + start * channels;
+
+    if (step == 1.0) {
+        // Constant delay: one contiguous run with a fixed fraction
+        const float b = gain * static_cast<float>(frac);
+        const float a = gain - b;
+        const size_t count = frames * channels;
+        for (size_t i = 0; i < count; ++i) {
+            out[i] += a * base[i] + b * base[i + channels];
+        }
+        return;
+    }
+
+    double position = frac;
+    for (size_t n = 0; n < frames; ++n) {
+        size_t whole = static_cast<size_t>(position);
+        float f = static_cast<float>(position - static_cast<double>(whole));
+        const float* frame = base + whole * channels;
+        for (size_t ch = 0; ch < channels; ++ch) {
+            out[n * channels + ch] += gain * (frame[ch] + f * (frame[ch + channels] - frame[ch]));
+        }
+        position += step;
+    }
+}
+
+} // namespace
+
+struct Echo::Impl {
+    static constexpr double MAX_DELAY = 5.0; // seconds
+
+    // Frames processed per pass; also bounds how far a run can read
+    static constexpr size_t BLOCK_FRAMES = 256;
+
+    // A changed delay glides to its new value over the next pass if that
+    // needs at most this many samples of movement per sample; larger
+    // changes are configuration, not modulation, and jump
+    static constexpr double MAX_SLEW = 0.5;
+
+    // Frames mirrored past the end of the ring so a run never wraps
+    static constexpr size_t GUARD_FRAMES = 2 * BLOCK_FRAMES + 4;
+
+    struct DelayTap {
+        double current = 1.0; // delay in samples at the read head
+        double target = 1.0;  // reached by the end of the next pass
+        float level = 1.0f;
+    };
+
+    EchoParameters params;
+    std::vector<std::pair<double, double>> taps; // (delay in seconds, level)
+
+    // One interleaved power-of-two ring shared by the feedback path and all
+    // taps, plus GUARD_FRAMES mirrored frames. It only grows, when a longer
+    // delay is configured, never while processing.
+    std::vector<float> buffer;
+    size_t ringFrames = 0;
+    size_t mask = 0;
+    size_t writePos = 0;
+
+    DelayTap feedbackTap;
+    std::vector<DelayTap> tapLines;
+
+    // Per-pass scratch
+    std::vector<float> delayed;
+    std::vector<float> echo;
+
+    void updateDelayLine(bool snap);
+    void resize(size_t minFrames);
+    void write(const float* input, const float* delayedFrames, float feedback, size_t frames);
+    void read(DelayTap& tap, size_t frames, float gain, float* out);
+};
+
+Echo::Echo() : pImpl(std::make_unique<Impl>()) {
+    pImpl->updateDelayLine(true);
+}
+
+Echo::~Echo() = default;
+
+std::vector<float> Echo::apply(const std::vector<float>& input) {
+    std::vector<float> output(input);
+    process(input.data(), output.data(), input.size() / pImpl->params.channels);
+    return output;
+}
+
+void Echo::process(const float* input, float* output, size_t frames) {
+    auto& impl = *pImpl;
+    const size_t channels = static_cast<size_t>(impl.params.channels);
+    const float feedback = static_cast<float>(impl.params.feedback);
+    const float wet = static_cast<float>(impl.params.wetLevel);
+    const float dry = static_cast<float>(impl.params.dryLevel);
+    float* delayed = impl.delayed.data();
+    float* echo = impl.echo.data();
+
+    while (frames > 0) {
+        // The feedback read must only see frames written by earlier passes
+        const auto& fb = impl.feedbackTap;
+        double shortest = std::min(fb.current, fb.target);
+        size_t limit = std::max<size_t>(1, static_cast<size_t>(shortest) - 1);
+        size_t count = std::min({frames, Impl::BLOCK_FRAMES, limit});
+        size_t samples = count * channels;
+
+        std::fill(delayed, delayed + samples, 0.0f);
+        impl.read(impl.feedbackTap, count, 1.0f, delayed);
+        impl.write(input, delayed, feedback, count);
+
+        std::copy(delayed, delayed + samples, echo);
+        for (auto& tap : impl.tapLines) {
+            impl.read(tap, count, tap.level, echo);
+        }
+
+        for (size_t i = 0; i < samples; ++i) {
+            output[i] = dry * input[i] + wet * echo[i];
+        }
+
+        impl.writePos = (impl.writePos + count) & impl.mask;
+        input += samples;
+        output += samples;
+        frames -= count;
+    }
+}
+
+void Echo::setParameters(const EchoParameters& params) {
+    bool snap = std::max(1, params.sampleRate) != pImpl->params.sampleRate ||
+                std::max(1, params.channels) != pImpl->params.channels;
+    pImpl->params = params;
+    pImpl->params.delay = MathUtils::clamp(params.delay, 0.001, Impl::MAX_DELAY);
+    pImpl->params.feedback = MathUtils::clamp(params.feedback, 0.0, 0.9);
+    pImpl->params.wetLevel = MathUtils::clamp(params.wetLevel, 0.0, 1.0);
+    pImpl->params.dryLevel = MathUtils::clamp(params.dryLevel, 0.0, 1.0);
+    pImpl->params.sampleRate = std::max(1, params.sampleRate);
+    pImpl->params.channels = std::max(1, params.channels);
+    pImpl->updateDelayLine(snap);
+}
+
+void Echo::setDelay(double delay) {
+    pImpl->params.delay = MathUtils::clamp(delay, 0.001, Impl::MAX_DELAY);
+    pImpl->updateDelayLine(false);
+}
+
+void Echo::setFeedback(double feedback) {
+    pImpl->params.feedback = MathUtils::clamp(feedback, 0.0, 0.9);
+}
+
+void Echo::setWetLevel(double wetLevel) {
+    pImpl->params.wetLevel = MathUtils::clamp(wetLevel, 0.0, 1.0);
+}
+
+void Echo::setDryLevel(double dryLevel) {
+    pImpl->params.dryLevel = MathUtils::clamp(dryLevel, 0.0, 1.0);
+}
+
+void Echo::setSampleRate(int sampleRate) {
+    pImpl->params.sampleRate = std::max(1, sampleRate);
+    pImpl->updateDelayLine(true);
+}
+
+void Echo::setChannels(int channels) {
+    pImpl->params.channels = std::max(1, channels);
+    pImpl->updateDelayLine(true);
+}
+
+EchoParameters Echo::getParameters() const {
+    return pImpl->params;
+}
+
+void Echo::setPreset(const std::string& presetName) {
+    EchoParameters params = pImpl->params;
+
+    if (presetName == "slapback") {
+        params.delay = 0.08;
+        params.feedback = 0.1;
+        params.wetLevel = 0.5;
+        params.dryLevel = 0.8;
+    } else if (presetName == "tape") {
+        params.delay = 0.35;
+        params.feedback = 0.45;
+        params.wetLevel = 0.4;
+        params.dryLevel = 0.7;
+    } else if (presetName == "ambient") {
+        params.delay = 0.6;
+        params.feedback = 0.65;
+        params.wetLevel = 0.35;
+        params.dryLevel = 0.7;
+    } else {
+        throw std::invalid_argument("Unknown echo preset: " + presetName);
+    }
+
+    setParameters(params);
+}
+
+std::vector<std::string> Echo::getAvailablePresets() const {
+    return {"slapback", "tape", "ambient"};
+}
+
+void Echo::reset() {
+    pImpl->updateDelayLine(true);
+}
+
+void Echo::addTap(double delay, double level) {
+    pImpl->taps.emplace_back(MathUtils::clamp(delay, 0.001, Impl::MAX_DELAY), level);
+    pImpl->updateDelayLine(false);
+}
+
+void Echo::setTap(size_t index, double delay, double level) {
+    if (index >= pImpl->taps.size()) {
+        throw std::out_of_range("Echo tap index out of range: " + std::to_string(index));
+    }
+    pImpl->taps[index] = {MathUtils::clamp(delay, 0.001, Impl::MAX_DELAY), level};
+    pImpl->updateDelayLine(false);
+}
+
+void Echo::clearTaps() {
+    pImpl->taps.clear();
+    pImpl->updateDelayLine(false);
+}
+
+std::vector<std::pair<double, double>> Echo::getTaps() const {
+    return pImpl->taps;
+}
+
+void Echo::Impl::updateDelayLine(bool snap) {
+    auto toSamples = [this](double seconds) {
+        return std::max(1.0, seconds * params.sampleRate);
+    };
+
+    // New targets; read heads move there during the next pass unless
+    // snapping, and newly added taps start where they are aimed
+    size_t existing = std::min(tapLines.size(), taps.size());
+    tapLines.resize(taps.size());
+    feedbackTap.target = toSamples(params.delay);
+    for (size_t i = 0; i < taps.size(); ++i) {
+        tapLines[i].target = toSamples(taps[i].first);
+        tapLines[i].level = static_cast<float>(taps[i].second);
+        if (snap || i >= existing) tapLines[i].current = tapLines[i].target;
+    }
+    if (snap) feedbackTap.current = feedbackTap.target;
+
+    double longest = std::max(feedbackTap.current, feedbackTap.target);
+    for (const auto& line : tapLines) {
+        longest = std::max({longest, line.current, line.target});
+    }
+
+    if (snap) {
+        // Sample rate or layout changed: start again from silence
+        buffer.clear();
+        ringFrames = 0;
+        writePos = 0;
+    }
+    resize(std::max(static_cast<size_t>(std::ceil(longest)) + BLOCK_FRAMES + 2, 2 * GUARD_FRAMES));
+
+    size_t channels = static_cast<size_t>(params.channels);
+    delayed.assign(BLOCK_FRAMES * channels, 0.0f);
+    echo.assign(BLOCK_FRAMES * channels, 0.0f);
+}
+
+void Echo::Impl::resize(size_t minFrames) {
+    if (minFrames <= ringFrames) return;
+
+    size_t frames = static_cast<size_t>(MathUtils::nextPowerOfTwo(static_cast<int>(minFrames)));
+    size_t channels = static_cast<size_t>(params.channels);
+    std::vector<float> grown((frames + GUARD_FRAMES) * channels, 0.0f);
+
+    // Unroll the old ring oldest-first so history ends just before the
+    // new write position
+    for (size_t k = 0; k < ringFrames; ++k) {
+        const float* from = buffer.data() + ((writePos + k) & mask) * channels;
+        std::copy(from, from + channels, grown.data() + k * channels);
+    }
+    writePos = ringFrames & (frames - 1);
+
+    buffer.swap(grown);
+    ringFrames = frames;
+    mask = frames - 1;
+    std::copy(buffer.begin(), buffer.begin() + GUARD_FRAMES * channels, buffer.begin() + ringFrames * channels);
+}
+
+void Echo::Impl::write(const float* input, const float* delayedFrames, float feedback, size_t frames) {
+    const size_t channels = static_cast<size_t>(params.channels);
+    float* ring = buffer.data();
+
+    // At most two contiguous runs: up to the end of the ring, then from 0
+    size_t first = std::min(frames, ringFrames - writePos);
+    float* out = ring + writePos * channels;
+    for (size_t i = 0; i < first * channels; ++i) {
+        out[i] = input[i] + feedback * delayedFrames[i];
+    }
+    for (size_t i = first * channels; i < frames * channels; ++i) {
+        ring[i - first * channels] = input[i] + feedback * delayedFrames[i];
+    }
+
+    // Keep the guard region a copy of the start of the ring
+    // (the ring spans at least two guards, so a wrapping write only
+    // touches the guard through its second run)
+    size_t start = first < frames ? 0 : writePos;
+    size_t end = first < frames ? frames - first : writePos + frames;
+    if (start < GUARD_FRAMES) {
+        end = std::min(end, GUARD_FRAMES);
+        std::copy(ring + start * channels, ring + end * channels, ring + (ringFrames + start) * channels);
+    }
+}
+
+void Echo::Impl::read(DelayTap& tap, size_t frames, float gain, float* out) {
+    if (std::fabs(tap.target - tap.current) > MAX_SLEW * static_cast<double>(frames)) {
+        tap.current = tap.target;
+    }
+    double step = 1.0 - (tap.target - tap.current) / static_cast<double>(frames);
+
+    double position = static_cast<double>(writePos + ringFrames) - tap.current;
+    double whole = std::floor(position);
+    size_t start = static_cast<size_t>(whole) & mask;
+    accumulateTap(buffer.data(), static_cast<size_t>(params.channels), start, position - whole,
+                  tap.current == tap.target ? 1.0 : step, frames, gain, out);
+
+    tap.current = tap.target;
+}
+
+} // namespace effects
+} // namespace song_processor
@@ -0,0 +1,430 @@
+#include "effects/reverb.hpp"
+#include "audio/audio_loader.hpp"
+#include "signal/convolver.hpp"
+#include "utils/aligned_allocator.hpp"
+#include "utils/math_utils.hpp"
+#include "../utils/simd.hpp"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace song_processor {
+namespace effects {
+
+using utils::AlignedVector;
+using utils::Float4;
+using utils::MathUtils;
+
+namespace {
+
+// Freeverb tuning, in samples at 44.1 kHz
+constexpr int NUM_COMBS = 8;
+constexpr int NUM_ALLPASSES = 4;
+constexpr int COMB_TUNING[NUM_COMBS] = {1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617};
+constexpr int ALLPASS_TUNING[NUM_ALLPASSES] = {556, 441, 341, 225};
+constexpr int STEREO_SPREAD = 23;
+
+constexpr float FIXED_GAIN = 0.015f;
+constexpr float SCALE_WET = 3.0f;
+constexpr float SCALE_DRY = 2.0f;
+constexpr float SCALE_DAMP = 0.4f;
+constexpr float SCALE_ROOM = 0.28f;
+constexpr float OFFSET_ROOM = 0.7f;
+constexpr float ALLPASS_FEEDBACK = 0.5f;
+
+// Comb lanes are updated four at a time
+constexpr int COMB_VECTORS = NUM_COMBS / Float4::WIDTH;
+constexpr int ALLPASS_LANES = 2 * NUM_ALLPASSES;
+
+// Add and remove a tiny offset to flush denormals out of the comb filters
+constexpr float DENORMAL_GUARD = 1e-20f;
+
+} // namespace
+
+struct Reverb::Impl {
+    ReverbParameters params;
+
+    // Comb network. Every comb writes into the same row of one shared ring
+    // ([L0..L7] in mono, [L0..L7, R0..R7] in stereo), so a row is stored
+    // with vector writes and each lane reads its own delay back from an
+    // older row. Both channels run in one pass over the input.
+    AlignedVector<float> combRing;
+    AlignedVector<float> combFilter;       // one-pole damping state per lane
+    std::array<size_t, 2 * NUM_COMBS> combDelay{};
+    size_t combLanes = NUM_COMBS;
+    size_t combMask = 0;
+    size_t combPos = 0;
+
+    // Series allpasses, laid out the same way as [L0..L3, R0..R3]
+    AlignedVector<float> allpassRing;
+    std::array<size_t, ALLPASS_LANES> allpassDelay{};
+    size_t allpassMask = 0;
+    size_t allpassPos = 0;
+
+    // Derived gains
+    float feedback = 0.0f;
+    float damp1 = 0.0f;
+    float damp2 = 0.0f;
+    float wet1 = 0.0f;
+    float wet2 = 0.0f;
+    float dry = 0.0f;
+
+    // Impulse-response mode. The convolver delays the wet signal by one
+    // block, so the dry path is delayed to match.
+    static constexpr int IR_BLOCK_SIZE = 512;
+    static constexpr size_t CHUNK_FRAMES = 1024;
+    signal::Convolver convolver;
+    std::vector<float> wetBuffer;
+    std::vector<float> dryDelay;
+    size_t dryPos = 0;
+    float irWet1 = 0.0f;
+    float irWet2 = 0.0f;
+    float irDry = 0.0f;
+
+    void allocateBuffers();
+    void allocateDryDelay();
+    template <int Channels>
+    void processAlgorithmic(const float* input, float* output, size_t frames);
+    void updateGains();
+    void processConvolution(const float* input, float* output, size_t frames);
+};
+
+Reverb::Reverb() : pImpl(std::make_unique<Impl>()) {
+    pImpl->allocateBuffers();
+    pImpl->updateGains();
+}
+
+Reverb::~Reverb() = default;
+
+std::vector<float> Reverb::apply(const std::vector<float>& input) {
+    std::vector<float> output(input);
+    process(input.data(), output.data(), input.size() / pImpl->params.channels);
+    return output;
+}
+
+void Reverb::process(const float* input, float* output, size_t frames) {
+    auto& impl = *pImpl;
+    if (impl.convolver.hasImpulseResponse()) {
+        impl.processConvolution(input, output, frames);
+        return;
+    }
+
+    if (impl.params.channels == 2) {
+        impl.processAlgorithmic<2>(input, output, frames);
+    } else {
+        impl.processAlgorithmic<1>(input, output, frames);
+    }
+}
+
+void Reverb::setParameters(const ReverbParameters& params) {
+    bool reallocate = params.sampleRate != pImpl->params.sampleRate ||
+                      params.channels != pImpl->params.channels;
+    pImpl->params = params;
+    pImpl->params.roomSize = MathUtils::clamp(params.roomSize, 0.0, 1.0);
+    pImpl->params.damping = MathUtils::clamp(params.damping, 0.0, 1.0);
+    pImpl->params.wetLevel = MathUtils::clamp(params.wetLevel, 0.0, 1.0);
+    pImpl->params.dryLevel = MathUtils::clamp(params.dryLevel, 0.0, 1.0);
+    pImpl->params.width = MathUtils::clamp(params.width, 0.0, 1.0);
+    pImpl->params.sampleRate = std::max(1, params.sampleRate);
+    pImpl->params.channels = MathUtils::clamp(params.channels, 1, 2);
+    if (pImpl->params.channels != pImpl->convolver.getChannels()) {
+        pImpl->convolver.setChannels(pImpl->params.channels);
+        pImpl->allocateDryDelay();
+    }
+    if (reallocate) pImpl->allocateBuffers();
+    pImpl->updateGains();
+}
+
+void Reverb::setRoomSize(double roomSize) {
+    pImpl->params.roomSize = MathUtils::clamp(roomSize, 0.0, 1.0);
+    pImpl->updateGains();
+}
+
+void Reverb::setDamping(double damping) {
+    pImpl->params.damping = MathUtils::clamp(damping, 0.0, 1.0);
+    pImpl->updateGains();
+}
+
+void Reverb::setWetLevel(double wetLevel) {
+    pImpl->params.wetLevel = MathUtils::clamp(wetLevel, 0.0, 1.0);
+    pImpl->updateGains();
+}
+
+void Reverb::setDryLevel(double dryLevel) {
+    pImpl->params.dryLevel = MathUtils::clamp(dryLevel, 0.0, 1.0);
+    pImpl->updateGains();
+}
+
+void Reverb::setWidth(double width) {
+    pImpl->params.width = MathUtils::clamp(width, 0.0, 1.0);
+    pImpl->updateGains();
+}
+
+void Reverb::setSampleRate(int sampleRate) {
+    pImpl->params.sampleRate = std::max(1, sampleRate);
+    pImpl->allocateBuffers();
+}
+
+void Reverb::setChannels(int channels) {
+    pImpl->params.channels = MathUtils::clamp(channels, 1, MAX_CHANNELS);
+    pImpl->convolver.setChannels(pImpl->params.channels);
+    pImpl->allocateDryDelay();
+    pImpl->allocateBuffers();
+}
+
+ReverbParameters Reverb::getParameters() const {
+    return pImpl->params;
+}
+
+void Reverb::loadImpulseResponse(const std::string& filename) {
+    audio::AudioLoader loader;
+    auto file = loader.openFile(filename);
+    const auto& view = file->getView();
+
+    if (view.getSampleRate() != pImpl->params.sampleRate) {
+        throw std::runtime_error("Impulse response sample rate (" + std::to_string(view.getSampleRate()) +
+                                 " Hz) does not match reverb sample rate (" +
+                                 std::to_string(pImpl->params.sampleRate) + " Hz): " + filename);
+    }
+
+    std::vector<float> impulseResponse(view.getFrameCount() * view.getChannels());
+    view.readFrames(0, impulseResponse.data(), view.getFrameCount());
+    setImpulseResponse(impulseResponse, view.getChannels());
+}
+
+void Reverb::setImpulseResponse(const std::vector<float>& impulseResponse, int irChannels) {
+    if (irChannels < 1) {
+        throw std::invalid_argument("Impulse response needs at least one channel");
+    }
+    if (impulseResponse.size() < static_cast<size_t>(irChannels)) {
+        throw std::invalid_argument("Impulse response is empty");
+    }
+
+    pImpl->convolver.setChannels(pImpl->params.channels);
+    pImpl->convolver.setImpulseResponse(impulseResponse, irChannels, Impl::IR_BLOCK_SIZE);
+    pImpl->allocateDryDelay();
+}
+
+void Reverb::clearImpulseResponse() {
+    pImpl->convolver.clear();
+    pImpl->allocateDryDelay();
+}
+
+bool Reverb::hasImpulseResponse() const {
+    return pImpl->convolver.hasImpulseResponse();
+}
+
+int Reverb::getLatency() const {
+    return pImpl->convolver.hasImpulseResponse() ? pImpl->convolver.getLatency() : 0;
+}
+
+void Reverb::setPreset(const std::string& presetName) {
+    ReverbParameters params = pImpl->params;
+
+    if (presetName == "small_room") {
+        params.roomSize = 0.3;
+        params.damping = 0.6;
+        params.wetLevel = 0.25;
+        params.dryLevel = 0.5;
+        params.width = 0.8;
+    } else if (presetName == "large_hall") {
+        params.roomSize = 0.85;
+        params.damping = 0.4;
+        params.wetLevel = 0.35;
+        params.dryLevel = 0.4;
+        params.width = 1.0;
+    } else if (presetName == "plate") {
+        params.roomSize = 0.6;
+        params.damping = 0.2;
+        params.wetLevel = 0.3;
+        params.dryLevel = 0.45;
+        params.width = 1.0;
+    } else if (presetName == "cathedral") {
+        params.roomSize = 0.98;
+        params.damping = 0.3;
+        params.wetLevel = 0.4;
+        params.dryLevel = 0.35;
+        params.width = 1.0;
+    } else {
+        throw std::invalid_argument("Unknown reverb preset: " + presetName);
+    }
+
+    setParameters(params);
+}
+
+std::vector<std::string> Reverb::getAvailablePresets() const {
+    return {"small_room", "large_hall", "plate", "cathedral"};
+}
+
+void Reverb::reset() {
+    std::fill(pImpl->combRing.begin(), pImpl->combRing.end(), 0.0f);
+    std::fill(pImpl->combFilter.begin(), pImpl->combFilter.end(), 0.0f);
+    std::fill(pImpl->allpassRing.begin(), pImpl->allpassRing.end(), 0.0f);
+    pImpl->convolver.reset();
+    std::fill(pImpl->dryDelay.begin(), pImpl->dryDelay.end(), 0.0f);
+    pImpl->dryPos = 0;
+}
+
+void Reverb::Impl::allocateBuffers() {
+    // Scale the 44.1 kHz tuning to the current rate; the right channel is
+    // offset by a few samples to decorrelate it from the left
+    double scale = params.sampleRate / 44100.0;
+    size_t longestComb = 1;
+    size_t longestAllpass = 1;
+    for (int ch = 0; ch < 2; ++ch) {
+        int spread = ch * STEREO_SPREAD;
+        for (int c = 0; c < NUM_COMBS; ++c) {
+            size_t delay = std::max(1, static_cast<int>((COMB_TUNING[c] + spread) * scale));
+            combDelay[ch * NUM_COMBS + c] = delay;
+            longestComb = std::max(longestComb, delay);
+        }
+        for (int a = 0; a < NUM_ALLPASSES; ++a) {
+            size_t delay = std::max(1, static_cast<int>((ALLPASS_TUNING[a] + spread) * scale));
+            allpassDelay[ch * NUM_ALLPASSES + a] = delay;
+            longestAllpass = std::max(longestAllpass, delay);
+        }
+    }
+
+    // Power-of-two row counts so positions wrap with a mask
+    size_t combRows = static_cast<size_t>(MathUtils::nextPowerOfTwo(static_cast<int>(longestComb) + 1));
+    size_t allpassRows = static_cast<size_t>(MathUtils::nextPowerOfTwo(static_cast<int>(longestAllpass) + 1));
+
+    combLanes = static_cast<size_t>(params.channels) * NUM_COMBS;
+    combRing.assign(combRows * combLanes, 0.0f);
+    combFilter.assign(combLanes, 0.0f);
+    combMask = combRows - 1;
+    combPos = 0;
+
+    allpassRing.assign(allpassRows * ALLPASS_LANES, 0.0f);
+    allpassMask = allpassRows - 1;
+    allpassPos = 0;
+}
+
+void Reverb::Impl::allocateDryDelay() {
+    size_t latency = convolver.hasImpulseResponse() ? static_cast<size_t>(convolver.getLatency()) : 0;
+    dryDelay.assign(latency * params.channels, 0.0f);
+    dryPos = 0;
+    wetBuffer.assign(CHUNK_FRAMES * params.channels, 0.0f);
+}
+
+void Reverb::Impl::updateGains() {
+    feedback = static_cast<float>(params.roomSize) * SCALE_ROOM + OFFSET_ROOM;
+    damp1 = static_cast<float>(params.damping) * SCALE_DAMP;
+    damp2 = 1.0f - damp1;
+
+    float wet = static_cast<float>(params.wetLevel) * SCALE_WET;
+    float width = static_cast<float>(params.width);
+    wet1 = wet * (width / 2.0f + 0.5f);
+    wet2 = wet * ((1.0f - width) / 2.0f);
+    dry = static_cast<float>(params.dryLevel) * SCALE_DRY;
+
+    // A measured response carries its own level, so IR mode mixes unscaled
+    irWet1 = static_cast<float>(params.wetLevel) * (width / 2.0f + 0.5f);
+    irWet2 = static_cast<float>(params.wetLevel) * ((1.0f - width) / 2.0f);
+    irDry = static_cast<float>(params.dryLevel);
+}
+
+template <int Channels>
+void Reverb::Impl::processAlgorithmic(const float* input, float* output, size_t frames) {
+    constexpr int VECTORS = Channels * COMB_VECTORS;
+    constexpr size_t LANES = Channels * NUM_COMBS;
+
+    const Float4 feedbackV = Float4::broadcast(feedback);
+    const Float4 damp1V = Float4::broadcast(damp1);
+    const Float4 damp2V = Float4::broadcast(damp2);
+
+    Float4 filterStore[VECTORS];
+    for (int v = 0; v < VECTORS; ++v) {
+        filterStore[v] = Float4::load(combFilter.data() + v * Float4::WIDTH);
+    }
+
+    float* ring = combRing.data();
+    float* allpasses = allpassRing.data();
+    const size_t* delay = combDelay.data();
+
+    for (size_t i = 0; i < frames; ++i) {
+        float inL = input[i * Channels];
+        float inR = Channels == 2 ? input[i * Channels + 1] : inL;
+        const Float4 in = Float4::broadcast((inL + inR) * FIXED_GAIN);
+
+        // All combs of both channels: gather each lane's delayed sample,
+        // damp it, and write the new row in one go
+        float* row = ring + combPos * LANES;
+        Float4 acc[Channels];
+        for (int ch = 0; ch < Channels; ++ch) acc[ch] = Float4::zero();
+        for (int v = 0; v < VECTORS; ++v) {
+            const size_t lane = v * Float4::WIDTH;
+            Float4 out = Float4::set(ring[((combPos - delay[lane]) & combMask) * LANES + lane],
+                                     ring[((combPos - delay[lane + 1]) & combMask) * LANES + lane + 1],
+                                     ring[((combPos - delay[lane + 2]) & combMask) * LANES + lane + 2],
+                                     ring[((combPos - delay[lane + 3]) & combMask) * LANES + lane + 3]);
+            filterStore[v] = out * damp2V + filterStore[v] * damp1V;
+            (in + filterStore[v] * feedbackV).store(row + lane);
+            acc[v / COMB_VECTORS] += out;
+        }
+        combPos = (combPos + 1) & combMask;
+
+        float wet[Channels];
+        for (int ch = 0; ch < Channels; ++ch) wet[ch] = acc[ch].sum();
+
+        float* allpassRow = allpasses + allpassPos * ALLPASS_LANES;
+        for (int a = 0; a < NUM_ALLPASSES; ++a) {
+            for (int ch = 0; ch < Channels; ++ch) {
+                const size_t lane = ch * NUM_ALLPASSES + a;
+                float bufferOut = allpasses[((allpassPos - allpassDelay[lane]) & allpassMask) * ALLPASS_LANES + lane];
+                allpassRow[lane] = wet[ch] + bufferOut * ALLPASS_FEEDBACK;
+                wet[ch] = bufferOut - wet[ch];
+            }
+        }
+        allpassPos = (allpassPos + 1) & allpassMask;
+
+        if (Channels == 2) {
+            output[2 * i] = wet[0] * wet1 + wet[Channels - 1] * wet2 + inL * dry;
+            output[2 * i + 1] = wet[Channels - 1] * wet1 + wet[0] * wet2 + inR * dry;
+        } else {
+            output[i] = wet[0] * (wet1 + wet2) + inL * dry;
+        }
+    }
+
+    const Float4 guard = Float4::broadcast(DENORMAL_GUARD);
+    for (int v = 0; v < VECTORS; ++v) {
+        ((filterStore[v] + guard) - guard).store(combFilter.data() + v * Float4::WIDTH);
+    }
+}
+
+void Reverb::Impl::processConvolution(const float* input, float* output, size_t frames) {
+    const size_t channels = static_cast<size_t>(params.channels);
+    const bool stereo = channels == 2;
+
+    while (frames > 0) {
+        size_t count = std::min(frames, CHUNK_FRAMES);
+        convolver.process(input, wetBuffer.data(), count);
+
+        for (size_t i = 0; i < count; ++i) {
+            float* delayed = dryDelay.data() + dryPos;
+            if (stereo) {
+                float wetL = wetBuffer[2 * i];
+                float wetR = wetBuffer[2 * i + 1];
+                float dryL = delayed[0];
+                float dryR = delayed[1];
+                delayed[0] = input[2 * i];
+                delayed[1] = input[2 * i + 1];
+                output[2 * i] = wetL * irWet1 + wetR * irWet2 + dryL * irDry;
+                output[2 * i + 1] = wetR * irWet1 + wetL * irWet2 + dryR * irDry;
+            } else {
+                float dryM = delayed[0];
+                delayed[0] = input[i];
+                output[i] = wetBuffer[i] * (irWet1 + irWet2) + dryM * irDry;
+            }
+            dryPos += channels;
+            if (dryPos == dryDelay.size()) dryPos = 0;
+        }
+
+        input += count * channels;
+        output += count * channels;
+        frames -= count;
+    }
+}
+
+} // namespace effects
+} // namespace song_processor
@@ -0,0 +1,292 @@
+#include "processing/batch_processor.hpp"
+#include "audio/mapped_audio_file.hpp"
+#include "audio/wav_stream_writer.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <numeric>
+
+namespace song_processor {
+namespace processing {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Decides which job starts next. A job is admitted only when a worker is
+// free and its decoded size fits under the limit, and only then handed to
+// the pool, so no worker ever blocks waiting for memory. Jobs are taken in
+// arrival order; when the oldest does not fit, later ones that do may start
+// ahead of it, but only MAX_BYPASS times in a row. After that nothing new
+// starts until enough memory drains for it, so a long track cannot be
+// starved. A request larger than the limit is admitted once nothing else
+// is in flight.
+class MemoryBudget {
+public:
+    static constexpr size_t MAX_BYPASS = 64;
+
+    void reset(size_t bytes, size_t workers) {
+        std::lock_guard<std::mutex> lock(mutex);
+        limit = bytes;
+        slots = std::max<size_t>(1, workers);
+        inFlight = 0;
+        running = 0;
+        bypassed = 0;
+        peak = 0;
+    }
+
+    // Blocks the dispatching thread until one of the waiting jobs (indices
+    // into sizes, oldest first) can start, then removes and returns it
+    size_t admit(std::deque<size_t>& waiting, const std::vector<size_t>& sizes) {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            if (running < slots) {
+                size_t position = waiting.size();
+                if (fits(sizes[waiting.front()])) {
+                    position = 0;
+                } else if (bypassed < MAX_BYPASS) {
+                    for (size_t i = 1; i < waiting.size(); ++i) {
+                        if (fits(sizes[waiting[i]])) {
+                            position = i;
+                            break;
+                        }
+                    }
+                }
+
+                if (position < waiting.size()) {
+                    bypassed = position == 0 ? 0 : bypassed + 1;
+                    const size_t job = waiting[position];
+                    waiting.erase(waiting.begin() + static_cast<std::ptrdiff_t>(position));
+                    ++running;
+                    inFlight += sizes[job];
+                    peak = std::max(peak, inFlight);
+                    return job;
+                }
+            }
+            released.wait(lock);
+        }
+    }
+
+    void release(size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        --running;
+        inFlight -= bytes;
+        released.notify_one();
+    }
+
+    size_t getPeak() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return peak;
+    }
+
+private:
+    bool fits(size_t bytes) const { return inFlight == 0 || inFlight + bytes <= limit; }
+
+    mutable std::mutex mutex;
+    std::condition_variable released;
+    size_t limit = 0;
+    size_t slots = 1;
+    size_t inFlight = 0;
+    size_t running = 0;
+    size_t bypassed = 0;
+    size_t peak = 0;
+};
+
+// Returns an admitted job's reservation to the budget when it leaves scope
+class Reservation {
+public:
+    Reservation(MemoryBudget& budget, size_t bytes) : budget(budget), bytes(bytes) {}
+    ~Reservation() { budget.release(bytes); }
+
+    Reservation(const Reservation&) = delete;
+    Reservation& operator=(const Reservation&) = delete;
+
+private:
+    MemoryBudget& budget;
+    size_t bytes;
+};
+
+} // namespace
+
+double BatchJobResult::getAudioSeconds() const {
+    return sampleRate > 0 ? static_cast<double>(frames) / sampleRate : 0.0;
+}
+
+double BatchJobResult::getWorkSeconds() const {
+    return loadSeconds + processSeconds + analysisSeconds + writeSeconds;
+}
+
+double BatchJobResult::getRealtimeFactor() const {
+    const double work = getWorkSeconds();
+    return work > 0.0 ? getAudioSeconds() / work : 0.0;
+}
+
+class BatchProcessor::Impl {
+public:
+    // Frames converted per step when decoding and writing
+    static constexpr size_t BLOCK_FRAMES = 65536;
+
+    utils::ThreadPool pool;
+    MemoryBudget budget;
+    size_t memoryBudget = size_t(1) << 30;
+
+    TrackProcessor processor;
+    ProgressCallback progress;
+    std::mutex progressMutex;
+
+    audio::SampleFormat outputFormat = audio::SampleFormat::INT24;
+    bool dither = false;
+    bool analysis = true;
+
+    explicit Impl(size_t threads) : pool(threads) {}
+
+    void runJob(const BatchJob& job, BatchJobResult& result);
+};
+
+void BatchProcessor::Impl::runJob(const BatchJob& job, BatchJobResult& result) {
+    result.inputFile = job.inputFile;
+    result.outputFile = job.outputFile;
+
+    try {
+        auto start = Clock::now();
+        audio::MappedAudioFile file(job.inputFile);
+        const audio::AudioView& view = file.getView();
+        result.sampleRate = view.getSampleRate();
+        result.channels = view.getChannels();
+        result.frames = view.getFrameCount();
+        result.memoryBytes = view.getFrameCount() * view.getChannels() * sizeof(float);
+        double headerSeconds = secondsSince(start);
+
+        // Freed on return, before the caller returns the reservation
+        audio::AudioData track;
+
+        start = Clock::now();
+        track.sampleRate = view.getSampleRate();
+        track.channels = view.getChannels();
+        track.bitsPerSample = view.getBitsPerSample();
+        track.samples.resize(view.getFrameCount() * view.getChannels());
+        for (size_t frame = 0; frame < view.getFrameCount(); frame += BLOCK_FRAMES) {
+            view.readFrames(frame, track.samples.data() + frame * view.getChannels(), BLOCK_FRAMES);
+        }
+        result.loadSeconds = headerSeconds + secondsSince(start);
+
+        if (processor) {
+            start = Clock::now();
+            processor(track);
+            result.processSeconds = secondsSince(start);
+        }
+
+        if (analysis) {
+            start = Clock::now();
+            result.statistics = utils::AudioUtils::calculateStatistics(track.samples, track.channels);
+            result.analysisSeconds = secondsSince(start);
+        }
+
+        if (!job.outputFile.empty()) {
+            start = Clock::now();
+            audio::WavStreamWriter writer(job.outputFile, track.sampleRate, track.channels, outputFormat);
+            writer.setDither(dither);
+            const size_t frames = track.samples.size() / track.channels;
+            for (size_t frame = 0; frame < frames; frame += BLOCK_FRAMES) {
+                const size_t count = std::min(BLOCK_FRAMES, frames - frame);
+                writer.write(track.samples.data() + frame * track.channels, count);
+            }
+            writer.close();
+            result.writeSeconds = secondsSince(start);
+        }
+
+        result.success = true;
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+
+    if (progress) {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        progress(result);
+    }
+}
+
+BatchProcessor::BatchProcessor(size_t threads) : pImpl(std::make_unique<Impl>(threads)) {}
+
+BatchProcessor::~BatchProcessor() = default;
+
+void BatchProcessor::setProcessor(TrackProcessor processor) {
+    pImpl->processor = std::move(processor);
+}
+
+void BatchProcessor::setProgressCallback(ProgressCallback callback) {
+    pImpl->progress = std::move(callback);
+}
+
+void BatchProcessor::setMemoryBudget(size_t bytes) {
+    pImpl->memoryBudget = bytes;
+}
+
+size_t BatchProcessor::getMemoryBudget() const {
+    return pImpl->memoryBudget;
+}
+
+void BatchProcessor::setOutputFormat(audio::SampleFormat format) {
+    pImpl->outputFormat = format;
+}
+
+void BatchProcessor::setDither(bool enabled) {
+    pImpl->dither = enabled;
+}
+
+void BatchProcessor::setAnalysisEnabled(bool enabled) {
+    pImpl->analysis = enabled;
+}
+
+std::vector<BatchJobResult> BatchProcessor::run(const std::vector<BatchJob>& jobs) {
+    std::vector<BatchJobResult> results(jobs.size());
+
+    // Decoded sizes from the file headers, so each job is admitted before
+    // a worker picks it up. A file that cannot be opened costs nothing and
+    // reports its error from the worker.
+    std::vector<size_t> sizes(jobs.size(), 0);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        try {
+            audio::MappedAudioFile file(jobs[i].inputFile);
+            const audio::AudioView& view = file.getView();
+            sizes[i] = view.getFrameCount() * view.getChannels() * sizeof(float);
+        } catch (const std::exception&) {
+        }
+    }
+
+    pImpl->budget.reset(pImpl->memoryBudget, pImpl->pool.getThreadCount());
+    std::deque<size_t> waiting(jobs.size());
+    std::iota(waiting.begin(), waiting.end(), size_t(0));
+
+    const auto start = Clock::now();
+    while (!waiting.empty()) {
+        const size_t i = pImpl->budget.admit(waiting, sizes);
+        results[i].budgetWaitSeconds = secondsSince(start);
+        pImpl->pool.submit([this, &jobs, &results, &sizes, i] {
+            Reservation reservation(pImpl->budget, sizes[i]);
+            pImpl->runJob(jobs[i], results[i]);
+        });
+    }
+    pImpl->pool.wait();
+
+    return results;
+}
+
+size_t BatchProcessor::getPeakMemoryInFlight() const {
+    return pImpl->budget.getPeak();
+}
+
+size_t BatchProcessor::getThreadCount() const {
+    return pImpl->pool.getThreadCount();
+}
+
+} // namespace processing
+} // namespace song_processor
@@ -0,0 +1,410 @@
+#include "processing/processing_chain.hpp"
+#include "utils/aligned_allocator.hpp"
+#include "utils/spsc_queue.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace song_processor {
+namespace processing {
+
+namespace {
+
+// Blocks in flight in a pipeline; a power of two for the queues
+constexpr size_t PIPELINE_SLOTS = 8;
+
+using SlotQueue = utils::SpscQueue<uint32_t, PIPELINE_SLOTS>;
+
+// Where stages sleep once spinning has not helped, so a stage waiting on
+// a slower neighbour does not burn a core. Every successful queue operation
+// may unblock a neighbour and calls notify(), which costs a fence and a
+// load unless some stage is parked. The fences on both sides order the
+// queue access against the sleeper count, so a wake-up cannot be lost.
+class Parking {
+public:
+    template <typename Ready>
+    void wait(Ready ready) {
+        sleepers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, ready);
+        }
+        sleepers.fetch_sub(1);
+    }
+
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            wake.notify_all();
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::atomic<int> sleepers{0};
+};
+
+// Retry a queue operation until it succeeds or another stage has failed.
+// Waits are usually short, so spin, then yield, then park.
+template <typename Operation>
+bool retry(Operation operation, const std::atomic<bool>& failed, Parking& parking) {
+    bool done = operation();
+    for (unsigned spins = 0; !done && spins < 128; ++spins) {
+        if (failed.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (spins >= 64) {
+            std::this_thread::yield();
+        }
+        done = operation();
+    }
+    if (!done) {
+        parking.wait([&] { return failed.load() || (done = operation()); });
+    }
+    if (done) {
+        parking.notify();
+    }
+    return done;
+}
+
+// Joins the stage threads on every exit. If starting one throws, the
+// stages already running are told to stop before the join, so they do
+// not wait forever on queues nobody will fill.
+class StageThreads {
+public:
+    StageThreads(std::atomic<bool>& failed, Parking& parking) : failed(failed), parking(parking) {}
+
+    ~StageThreads() {
+        if (!threads.empty() && threads.front().joinable()) {
+            failed = true;
+            parking.notify();
+            join();
+        }
+    }
+
+    StageThreads(const StageThreads&) = delete;
+    StageThreads& operator=(const StageThreads&) = delete;
+
+    template <typename Function>
+    void start(Function function, size_t stage) {
+        threads.emplace_back(function, stage);
+    }
+
+    void join() {
+        for (auto& thread : threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+private:
+    std::vector<std::thread> threads;
+    std::atomic<bool>& failed;
+    Parking& parking;
+};
+
+} // namespace
+
+class ProcessingChain::Impl {
+public:
+    // 512 stereo frames keep both scratch buffers at 4 KiB each, well
+    // inside L1 alongside the effects' own state
+    static constexpr size_t DEFAULT_BLOCK_FRAMES = 512;
+    static constexpr size_t MAX_BLOCK_FRAMES = 65536;
+
+    struct Stage {
+        StageFunction process;
+        std::function<int()> latency;
+        std::function<void()> reset;
+        std::function<void(int)> setChannels;
+        int maxChannels = 0;  // Widest frame the stage handles; 0 for any
+    };
+
+    std::vector<Stage> stages;
+    int channels;
+    size_t blockFrames;
+    utils::AlignedVector<float> scratch[2];
+    utils::AlignedVector<float> pipelineBlocks;  // PIPELINE_SLOTS blocks, on first use
+
+    void allocateScratch() {
+        for (auto& buffer : scratch) {
+            buffer.assign(blockFrames * channels, 0.0f);
+        }
+        pipelineBlocks.clear();
+    }
+
+    template <typename Effect>
+    Stage wrap(Effect& effect) {
+        Stage stage;
+        stage.process = [&effect](const float* input, float* output, size_t frames) {
+            effect.process(input, output, frames);
+        };
+        stage.reset = [&effect] { effect.reset(); };
+        stage.setChannels = [&effect](int count) { effect.setChannels(count); };
+        stage.latency = [] { return 0; };
+        return stage;
+    }
+
+    // A stage fed wider frames than it handles would step over them with
+    // the wrong stride and leave the rest of the block stale
+    void checkChannels(const Stage& stage, int count) const {
+        if (stage.maxChannels > 0 && count > stage.maxChannels) {
+            throw std::invalid_argument("ProcessingChain stage handles at most " +
+                                        std::to_string(stage.maxChannels) + " channels, chain has " +
+                                        std::to_string(count));
+        }
+    }
+
+    void addStage(Stage stage) {
+        checkChannels(stage, channels);
+        if (stage.setChannels) {
+            stage.setChannels(channels);
+        }
+        stages.push_back(std::move(stage));
+    }
+};
+
+ProcessingChain::ProcessingChain(int channels, size_t blockFrames) : pImpl(std::make_unique<Impl>()) {
+    pImpl->channels = std::max(1, channels);
+    pImpl->blockFrames = blockFrames == 0
+                             ? Impl::DEFAULT_BLOCK_FRAMES
+                             : std::min(blockFrames, Impl::MAX_BLOCK_FRAMES);
+    pImpl->allocateScratch();
+}
+
+ProcessingChain::~ProcessingChain() = default;
+
+ProcessingChain& ProcessingChain::add(signal::Filter& filter) {
+    pImpl->addStage(pImpl->wrap(filter));
+    return *this;
+}
+
+ProcessingChain& ProcessingChain::add(effects::Compressor& compressor) {
+    auto stage = pImpl->wrap(compressor);
+    stage.latency = [&compressor] { return compressor.getLatency(); };
+    pImpl->addStage(std::move(stage));
+    return *this;
+}
+
+ProcessingChain& ProcessingChain::add(effects::Echo& echo) {
+    pImpl->addStage(pImpl->wrap(echo));
+    return *this;
+}
+
+ProcessingChain& ProcessingChain::add(effects::Reverb& reverb) {
+    auto stage = pImpl->wrap(reverb);
+    stage.latency = [&reverb] { return reverb.getLatency(); };
+    stage.maxChannels = effects::Reverb::MAX_CHANNELS;
+    pImpl->addStage(std::move(stage));
+    return *this;
+}
+
+ProcessingChain& ProcessingChain::add(StageFunction function, int latency, std::function<void()> reset) {
+    Impl::Stage stage;
+    stage.process = std::move(function);
+    stage.latency = [latency] { return latency; };
+    stage.reset = std::move(reset);
+    pImpl->addStage(std::move(stage));
+    return *this;
+}
+
+void ProcessingChain::clear() {
+    pImpl->stages.clear();
+}
+
+void ProcessingChain::process(const float* input, float* output, size_t frames) {
+    auto& impl = *pImpl;
+    const size_t channels = static_cast<size_t>(impl.channels);
+    const size_t stageCount = impl.stages.size();
+
+    if (stageCount == 0) {
+        if (input != output) {
+            std::copy(input, input + frames * channels, output);
+        }
+        return;
+    }
+
+    for (size_t start = 0; start < frames; start += impl.blockFrames) {
+        const size_t count = std::min(impl.blockFrames, frames - start);
+        const float* source = input + start * channels;
+        float* destination = output + start * channels;
+
+        // Each stage reads the previous stage's scratch buffer and writes
+        // the other one; the last writes straight to the output
+        for (size_t s = 0; s < stageCount; ++s) {
+            float* target = s + 1 == stageCount ? destination : impl.scratch[s & 1].data();
+            impl.stages[s].process(source, target, count);
+            source = target;
+        }
+    }
+}
+
+void ProcessingChain::processPipelined(const float* input, float* output, size_t frames) {
+    auto& impl = *pImpl;
+    const size_t stageCount = impl.stages.size();
+    if (stageCount < 2 || frames <= impl.blockFrames) {
+        process(input, output, frames);
+        return;
+    }
+
+    const size_t channels = static_cast<size_t>(impl.channels);
+    const size_t blockSamples = impl.blockFrames * channels;
+    const size_t blocks = (frames + impl.blockFrames - 1) / impl.blockFrames;
+    if (impl.pipelineBlocks.empty()) {
+        impl.pipelineBlocks.assign(PIPELINE_SLOTS * blockSamples, 0.0f);
+    }
+
+    // hops[s] carries finished slots from stage s to stage s + 1; the last
+    // hop returns them from the final stage to the first
+    std::vector<std::unique_ptr<SlotQueue>> hops(stageCount);
+    for (auto& hop : hops) {
+        hop = std::make_unique<SlotQueue>();
+    }
+    std::atomic<bool> failed{false};
+    Parking parking;
+    std::vector<std::exception_ptr> errors(stageCount);
+
+    auto runStage = [&](size_t s) {
+        try {
+            SlotQueue& in = *hops[(s + stageCount - 1) % stageCount];
+            SlotQueue& out = *hops[s];
+            const bool first = s == 0;
+            const bool last = s + 1 == stageCount;
+
+            for (size_t k = 0; k < blocks; ++k) {
+                const size_t start = k * impl.blockFrames;
+                const size_t count = std::min(impl.blockFrames, frames - start);
+
+                // The first stage starts with every slot free and then
+                // reuses the ones the last stage hands back
+                uint32_t slot = static_cast<uint32_t>(k);
+                if (!first || k >= PIPELINE_SLOTS) {
+                    if (!retry([&] { return in.tryPop(slot); }, failed, parking)) return;
+                }
+                float* block = impl.pipelineBlocks.data() + slot * blockSamples;
+
+                if (first) {
+                    impl.stages[s].process(input + start * channels, block, count);
+                } else if (last) {
+                    impl.stages[s].process(block, output + start * channels, count);
+                } else {
+                    impl.stages[s].process(block, block, count);
+                }
+
+                // The final stage's hand-back is only read while blocks remain
+                if (!last || k + PIPELINE_SLOTS < blocks) {
+                    if (!retry([&] { return out.tryPush(slot); }, failed, parking)) return;
+                }
+            }
+        } catch (...) {
+            errors[s] = std::current_exception();
+            failed = true;
+            parking.notify();
+        }
+    };
+
+    // Dedicated threads rather than a pool: the stages block on each other
+    // and must all run at once
+    {
+        StageThreads threads(failed, parking);
+        for (size_t s = 0; s + 1 < stageCount; ++s) {
+            threads.start(runStage, s);
+        }
+        runStage(stageCount - 1); // The calling thread runs the last stage
+        threads.join();
+    }
+
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+std::vector<float> ProcessingChain::apply(const std::vector<float>& input) {
+    std::vector<float> output(input.size());
+    process(input.data(), output.data(), input.size() / pImpl->channels);
+    return output;
+}
+
+void ProcessingChain::reset() {
+    for (auto& stage : pImpl->stages) {
+        if (stage.reset) {
+            stage.reset();
+        }
+    }
+}
+
+void ProcessingChain::setChannels(int channels) {
+    channels = std::max(1, channels);
+    for (const auto& stage : pImpl->stages) {
+        pImpl->checkChannels(stage, channels);
+    }
+    pImpl->channels = channels;
+    for (auto& stage : pImpl->stages) {
+        if (stage.setChannels) {
+            stage.setChannels(pImpl->channels);
+        }
+    }
+    pImpl->allocateScratch();
+}
+
+int ProcessingChain::getChannels() const {
+    return pImpl->channels;
+}
+
+void ProcessingChain::setBlockSize(size_t frames) {
+    pImpl->blockFrames = std::max<size_t>(1, std::min(frames, Impl::MAX_BLOCK_FRAMES));
+    pImpl->allocateScratch();
+}
+
+size_t ProcessingChain::getBlockSize() const {
+    return pImpl->blockFrames;
+}
+
+size_t ProcessingChain::getStageCount() const {
+    return pImpl->stages.size();
+}
+
+int ProcessingChain::getLatency() const {
+    int latency = 0;
+    for (const auto& stage : pImpl->stages) {
+        latency += stage.latency();
+    }
+    return latency;
+}
+
+void processChannels(const std::vector<ProcessingChain*>& chains, audio::AudioBufferView buffer, bool pipelined) {
+    if (chains.size() != static_cast<size_t>(buffer.getChannels())) {
+        throw std::invalid_argument("processChannels needs one chain per channel");
+    }
+    for (const auto* chain : chains) {
+        if (chain == nullptr || chain->getChannels() != 1) {
+            throw std::invalid_argument("processChannels chains must be single-channel");
+        }
+    }
+
+    // Channels run on the shared pool and the calling thread; the first
+    // error is rethrown once every channel has finished
+    utils::ThreadPool::shared().parallelFor(chains.size(), [&](size_t c) {
+        float* samples = buffer.getChannel(static_cast<int>(c));
+        if (pipelined) {
+            chains[c]->processPipelined(samples, samples, buffer.getFrameCount());
+        } else {
+            chains[c]->process(samples, samples, buffer.getFrameCount());
+        }
+    });
+}
+
+} // namespace processing
+} // namespace song_processor
@@ -0,0 +1,222 @@
+#include "signal/convolver.hpp"
+#include "signal/fft.hpp"
+#include "utils/aligned_allocator.hpp"
+#include "utils/math_utils.hpp"
+#include <algorithm>
+#include <complex>
+#include <stdexcept>
+
+namespace song_processor {
+namespace signal {
+
+using utils::AlignedVector;
+using utils::MathUtils;
+
+namespace {
+
+using Complex = std::complex<double>;
+
+// acc += x * h over n bins, written out on the interleaved doubles so the
+// loop vectorises and avoids the NaN-checking complex multiply
+void multiplyAccumulate(const Complex* x, const Complex* h, Complex* acc, size_t n) {
+    const double* xs = reinterpret_cast<const double*>(x);
+    const double* hs = reinterpret_cast<const double*>(h);
+    double* as = reinterpret_cast<double*>(acc);
+    for (size_t i = 0; i < n; ++i) {
+        double xr = xs[2 * i], xi = xs[2 * i + 1];
+        double hr = hs[2 * i], hi = hs[2 * i + 1];
+        as[2 * i] += xr * hr - xi * hi;
+        as[2 * i + 1] += xr * hi + xi * hr;
+    }
+}
+
+} // namespace
+
+struct Convolver::Impl {
+    int channels = 1;
+    int irChannels = 1;
+    size_t irLength = 0;
+    size_t blockSize = 512;
+    size_t numBins = 257;
+    size_t numPartitions = 0;
+
+    FFT fft;
+
+    // Partition spectra, [irChannel][partition][bin]
+    AlignedVector<Complex> partitions;
+
+    // Per-channel state
+    AlignedVector<float> windows;    // [channel][2 * blockSize]: previous block | current block
+    AlignedVector<Complex> delayLine; // [channel][partition][bin], ring indexed by head
+    AlignedVector<float> outputs;    // [channel][blockSize]: block being played out
+    size_t head = 0;
+    size_t fill = 0;
+
+    // Scratch
+    AlignedVector<Complex> accumulator;
+    AlignedVector<float> timeBuffer;
+
+    void allocateState();
+    void processBlock();
+};
+
+Convolver::Convolver() : pImpl(std::make_unique<Impl>()) {}
+
+Convolver::~Convolver() = default;
+
+void Convolver::setImpulseResponse(const float* impulseResponse, size_t frames, int irChannels, int blockSize) {
+    if (irChannels < 1) {
+        throw std::invalid_argument("Impulse response needs at least one channel");
+    }
+    if (blockSize < 16) {
+        throw std::invalid_argument("Convolution block size must be at least 16");
+    }
+
+    auto& impl = *pImpl;
+    impl.irChannels = irChannels;
+    impl.irLength = frames;
+    impl.blockSize = static_cast<size_t>(MathUtils::nextPowerOfTwo(blockSize));
+    impl.numBins = impl.blockSize + 1;
+    impl.numPartitions = (frames + impl.blockSize - 1) / impl.blockSize;
+    impl.fft.setSize(static_cast<int>(2 * impl.blockSize));
+
+    // Transform each zero-padded partition once, up front
+    impl.partitions.assign(irChannels * impl.numPartitions * impl.numBins, Complex(0.0));
+    std::vector<float> padded(2 * impl.blockSize);
+    for (int c = 0; c < irChannels; ++c) {
+        for (size_t p = 0; p < impl.numPartitions; ++p) {
+            std::fill(padded.begin(), padded.end(), 0.0f);
+            size_t start = p * impl.blockSize;
+            size_t count = std::min(impl.blockSize, frames - start);
+            for (size_t i = 0; i < count; ++i) {
+                padded[i] = impulseResponse[(start + i) * irChannels + c];
+            }
+            Complex* spectrum = impl.partitions.data() + (c * impl.numPartitions + p) * impl.numBins;
+            impl.fft.forwardReal(padded.data(), spectrum);
+        }
+    }
+
+    impl.allocateState();
+}
+
+void Convolver::setImpulseResponse(const std::vector<float>& impulseResponse, int irChannels, int blockSize) {
+    setImpulseResponse(impulseResponse.data(), impulseResponse.size() / std::max(1, irChannels), irChannels, blockSize);
+}
+
+void Convolver::clear() {
+    pImpl->irLength = 0;
+    pImpl->numPartitions = 0;
+    pImpl->partitions.clear();
+    pImpl->allocateState();
+}
+
+void Convolver::process(const float* input, float* output, size_t frames) {
+    auto& impl = *pImpl;
+    const size_t channels = static_cast<size_t>(impl.channels);
+
+    if (impl.numPartitions == 0) {
+        std::fill(output, output + frames * channels, 0.0f); // Nothing to convolve with
+        return;
+    }
+
+    const size_t blockSize = impl.blockSize;
+    while (frames > 0) {
+        size_t count = std::min(frames, blockSize - impl.fill);
+
+        // Queue input behind the previous block and play out the last
+        // computed block; each element is read before it is overwritten
+        for (size_t ch = 0; ch < channels; ++ch) {
+            float* window = impl.windows.data() + ch * 2 * blockSize + blockSize + impl.fill;
+            const float* block = impl.outputs.data() + ch * blockSize + impl.fill;
+            for (size_t i = 0; i < count; ++i) {
+                window[i] = input[i * channels + ch];
+                output[i * channels + ch] = block[i];
+            }
+        }
+
+        impl.fill += count;
+        input += count * channels;
+        output += count * channels;
+        frames -= count;
+
+        if (impl.fill == blockSize) {
+            impl.processBlock();
+            impl.fill = 0;
+        }
+    }
+}
+
+void Convolver::reset() {
+    auto& impl = *pImpl;
+    std::fill(impl.windows.begin(), impl.windows.end(), 0.0f);
+    std::fill(impl.delayLine.begin(), impl.delayLine.end(), Complex(0.0));
+    std::fill(impl.outputs.begin(), impl.outputs.end(), 0.0f);
+    impl.head = 0;
+    impl.fill = 0;
+}
+
+void Convolver::setChannels(int channels) {
+    pImpl->channels = std::max(1, channels);
+    pImpl->allocateState();
+}
+
+int Convolver::getChannels() const {
+    return pImpl->channels;
+}
+
+int Convolver::getBlockSize() const {
+    return static_cast<int>(pImpl->blockSize);
+}
+
+int Convolver::getLatency() const {
+    return static_cast<int>(pImpl->blockSize);
+}
+
+size_t Convolver::getImpulseResponseLength() const {
+    return pImpl->irLength;
+}
+
+bool Convolver::hasImpulseResponse() const {
+    return pImpl->numPartitions > 0;
+}
+
+void Convolver::Impl::allocateState() {
+    windows.assign(channels * 2 * blockSize, 0.0f);
+    delayLine.assign(channels * numPartitions * numBins, Complex(0.0));
+    outputs.assign(channels * blockSize, 0.0f);
+    accumulator.assign(numBins, Complex(0.0));
+    timeBuffer.assign(2 * blockSize, 0.0f);
+    head = 0;
+    fill = 0;
+}
+
+void Convolver::Impl::processBlock() {
+    for (int ch = 0; ch < channels; ++ch) {
+        float* window = windows.data() + ch * 2 * blockSize;
+        Complex* channelLine = delayLine.data() + ch * numPartitions * numBins;
+        const Complex* channelPartitions = partitions.data() + (irChannels == 1 ? 0 : ch % irChannels) * numPartitions * numBins;
+
+        // Newest input spectrum enters the frequency-domain delay line
+        fft.forwardReal(window, channelLine + head * numBins);
+
+        // Y = sum_p X[n - p] H[p]
+        std::fill(accumulator.begin(), accumulator.end(), Complex(0.0));
+        for (size_t p = 0; p < numPartitions; ++p) {
+            size_t slot = (head + numPartitions - p) % numPartitions;
+            multiplyAccumulate(channelLine + slot * numBins, channelPartitions + p * numBins,
+                               accumulator.data(), numBins);
+        }
+
+        // Overlap-save: only the second half is free of circular wrap
+        fft.inverseReal(accumulator.data(), timeBuffer.data());
+        std::copy(timeBuffer.begin() + blockSize, timeBuffer.end(), outputs.begin() + ch * blockSize);
+
+        // Slide the input window by one block
+        std::copy(window + blockSize, window + 2 * blockSize, window);
+    }
+
+    head = (head + 1) % numPartitions;
+}
+
+} // namespace signal
+} // namespace song_processor
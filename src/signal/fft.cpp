@@ -0,0 +1,131 @@
+#include "signal/fft.hpp"
+#include "fft_plan.hpp"
+#include "utils/math_utils.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace song_processor {
+namespace signal {
+
+using utils::MathUtils;
+using utils::WindowType;
+
+struct FFT::Impl {
+    static constexpr int DEFAULT_SIZE = 1024;
+    static constexpr double KAISER_BETA = 8.6;
+
+    // Shared, immutable plan from the process-wide registry
+    const FFTPlan* plan = nullptr;
+
+    // Work buffers sized with the plan so transforms never allocate
+    std::vector<std::complex<double>> scratch;
+    std::vector<std::complex<double>> bins;
+    std::vector<float> samples;
+
+    void rebuild(int size);
+};
+
+FFT::FFT() : pImpl(std::make_unique<Impl>()) {
+    pImpl->rebuild(Impl::DEFAULT_SIZE);
+}
+
+FFT::~FFT() = default;
+
+std::vector<std::complex<double>> FFT::forward(const std::vector<float>& input) {
+    const size_t size = pImpl->plan->getSize();
+
+    // Zero-pad or truncate to the transform size
+    auto& samples = pImpl->samples;
+    size_t count = std::min(input.size(), size);
+    std::copy(input.begin(), input.begin() + count, samples.begin());
+    std::fill(samples.begin() + count, samples.end(), 0.0f);
+
+    std::vector<std::complex<double>> spectrum(size);
+    pImpl->plan->forwardReal(samples.data(), spectrum.data(), pImpl->scratch.data());
+
+    // Mirror the Hermitian half to return the full spectrum
+    for (size_t k = size / 2 + 1; k < size; ++k) {
+        spectrum[k] = std::conj(spectrum[size - k]);
+    }
+    return spectrum;
+}
+
+std::vector<float> FFT::inverse(const std::vector<std::complex<double>>& input) {
+    const size_t size = pImpl->plan->getSize();
+
+    auto& bins = pImpl->bins;
+    size_t count = std::min(input.size(), size);
+    std::copy(input.begin(), input.begin() + count, bins.begin());
+    std::fill(bins.begin() + count, bins.end(), std::complex<double>(0.0));
+
+    pImpl->plan->inverse(bins.data(), pImpl->scratch.data());
+
+    std::vector<float> output(size);
+    double scale = 1.0 / static_cast<double>(size);
+    for (size_t n = 0; n < size; ++n) {
+        output[n] = static_cast<float>(bins[n].real() * scale);
+    }
+    return output;
+}
+
+void FFT::forwardReal(const float* input, std::complex<double>* output) {
+    pImpl->plan->forwardReal(input, output, pImpl->scratch.data());
+}
+
+void FFT::inverseReal(const std::complex<double>* input, float* output) {
+    const size_t size = pImpl->plan->getSize();
+    pImpl->plan->inverseReal(input, output, pImpl->scratch.data());
+
+    float scale = 1.0f / static_cast<float>(size);
+    for (size_t n = 0; n < size; ++n) {
+        output[n] *= scale;
+    }
+}
+
+void FFT::setSize(int size) {
+    if (size < 2) {
+        throw std::invalid_argument("FFT size must be at least 2");
+    }
+    if (static_cast<size_t>(size) != pImpl->plan->getSize()) {
+        pImpl->rebuild(size);
+    }
+}
+
+int FFT::getSize() const {
+    return static_cast<int>(pImpl->plan->getSize());
+}
+
+std::vector<double> FFT::getMagnitude(const std::vector<std::complex<double>>& spectrum) {
+    return MathUtils::magnitude(spectrum);
+}
+
+std::vector<double> FFT::getPhase(const std::vector<std::complex<double>>& spectrum) {
+    return MathUtils::phase(spectrum);
+}
+
+std::vector<float> FFT::applyWindow(const std::vector<float>& input, const std::string& windowType) {
+    WindowType type = MathUtils::parseWindowType(windowType);
+    double parameter = type == WindowType::KAISER ? Impl::KAISER_BETA : 0.0;
+    // Input lengths vary without bound, so the window is not cached
+    const auto window = MathUtils::buildWindow(type, static_cast<int>(input.size()), parameter);
+
+    std::vector<float> output(input.size());
+    for (size_t i = 0; i < input.size(); ++i) {
+        output[i] = input[i] * window[i];
+    }
+    return output;
+}
+
+std::vector<std::string> FFT::getAvailableWindows() const {
+    return {"hanning", "hamming", "blackman", "kaiser", "rectangular"};
+}
+
+void FFT::Impl::rebuild(int size) {
+    plan = &FFTPlan::get(static_cast<size_t>(size));
+    scratch.assign(plan->getScratchSize(), std::complex<double>(0.0));
+    bins.assign(size, std::complex<double>(0.0));
+    samples.assign(size, 0.0f);
+}
+
+} // namespace signal
+} // namespace song_processor
@@ -0,0 +1,249 @@
+#include "fft_plan.hpp"
+#include "utils/math_utils.hpp"
+#include "utils/lock_free_cache.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace song_processor {
+namespace signal {
+
+using utils::MathUtils;
+
+namespace {
+
+using Complex = std::complex<double>;
+
+template <bool Inverse>
+void butterflies(Complex* data, size_t size, const Complex* twiddles) {
+    // twiddles holds the len/2 factors of each stage back to back
+    const Complex* stageTwiddles = twiddles;
+    for (size_t half = 1; half < size; half <<= 1) {
+        for (size_t start = 0; start < size; start += 2 * half) {
+            Complex* a = data + start;
+            Complex* b = a + half;
+            for (size_t j = 0; j < half; ++j) {
+                // Spelled out so the compiler does not emit the
+                // NaN-checking library call behind complex operator*
+                double wr = stageTwiddles[j].real();
+                double wi = Inverse ? -stageTwiddles[j].imag() : stageTwiddles[j].imag();
+                double br = b[j].real();
+                double bi = b[j].imag();
+                Complex t(br * wr - bi * wi, br * wi + bi * wr);
+                b[j] = a[j] - t;
+                a[j] += t;
+            }
+        }
+        stageTwiddles += half;
+    }
+}
+
+} // namespace
+
+ComplexFFTPlan::ComplexFFTPlan(size_t size) : size(size), powerOfTwo(false) {
+    if (size == 0 || size > (1u << 30)) {
+        throw std::invalid_argument("Invalid FFT size: " + std::to_string(size));
+    }
+    powerOfTwo = (size & (size - 1)) == 0;
+
+    if (powerOfTwo) {
+        int bits = MathUtils::log2(static_cast<int>(size));
+        bitReverse.resize(size);
+        for (size_t i = 0; i < size; ++i) {
+            uint32_t reversed = 0;
+            for (int b = 0; b < bits; ++b) {
+                reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+            }
+            bitReverse[i] = reversed;
+        }
+
+        twiddles.reserve(size > 1 ? size - 1 : 0);
+        for (size_t half = 1; half < size; half <<= 1) {
+            for (size_t j = 0; j < half; ++j) {
+                twiddles.push_back(std::polar(1.0, -MathUtils::PI * static_cast<double>(j) / half));
+            }
+        }
+        return;
+    }
+
+    // Bluestein: X[k] = c[k] * sum_n (x[n] c[n]) conj(c[k - n]), c[n] = exp(-i pi n^2 / N),
+    // evaluated as a circular convolution of power-of-two length
+    size_t paddedSize = static_cast<size_t>(MathUtils::nextPowerOfTwo(static_cast<int>(2 * size - 1)));
+    padded = std::make_unique<ComplexFFTPlan>(paddedSize);
+
+    chirp.resize(size);
+    for (size_t n = 0; n < size; ++n) {
+        // Reduce n^2 modulo 2N to keep the phase argument small and exact
+        uint64_t n2 = (static_cast<uint64_t>(n) * n) % (2 * static_cast<uint64_t>(size));
+        chirp[n] = std::polar(1.0, -MathUtils::PI * static_cast<double>(n2) / size);
+    }
+
+    chirpSpectrum.assign(paddedSize, Complex(0.0));
+    chirpSpectrum[0] = std::conj(chirp[0]);
+    for (size_t n = 1; n < size; ++n) {
+        chirpSpectrum[n] = std::conj(chirp[n]);
+        chirpSpectrum[paddedSize - n] = std::conj(chirp[n]);
+    }
+    padded->forward(chirpSpectrum.data(), nullptr);
+
+    // Fold the 1/M of the padded inverse into the kernel
+    double scale = 1.0 / static_cast<double>(paddedSize);
+    for (auto& value : chirpSpectrum) {
+        value *= scale;
+    }
+}
+
+size_t ComplexFFTPlan::getScratchSize() const {
+    return powerOfTwo ? 0 : padded->getSize();
+}
+
+void ComplexFFTPlan::forward(Complex* data, Complex* scratch) const {
+    if (powerOfTwo) {
+        radix2(data, false);
+    } else {
+        bluestein(data, scratch, false);
+    }
+}
+
+void ComplexFFTPlan::inverse(Complex* data, Complex* scratch) const {
+    if (powerOfTwo) {
+        radix2(data, true);
+    } else {
+        bluestein(data, scratch, true);
+    }
+}
+
+void ComplexFFTPlan::radix2(Complex* data, bool inverse) const {
+    for (size_t i = 0; i < size; ++i) {
+        size_t j = bitReverse[i];
+        if (i < j) std::swap(data[i], data[j]);
+    }
+
+    if (inverse) {
+        butterflies<true>(data, size, twiddles.data());
+    } else {
+        butterflies<false>(data, size, twiddles.data());
+    }
+}
+
+void ComplexFFTPlan::bluestein(Complex* data, Complex* scratch, bool inverse) const {
+    // The inverse is the conjugate of the forward transform of the conjugate
+    const size_t paddedSize = padded->getSize();
+    for (size_t n = 0; n < size; ++n) {
+        Complex x = inverse ? std::conj(data[n]) : data[n];
+        scratch[n] = x * chirp[n];
+    }
+    std::fill(scratch + size, scratch + paddedSize, Complex(0.0));
+
+    padded->forward(scratch, nullptr);
+    for (size_t k = 0; k < paddedSize; ++k) {
+        scratch[k] *= chirpSpectrum[k];
+    }
+    padded->inverse(scratch, nullptr);
+
+    for (size_t k = 0; k < size; ++k) {
+        Complex y = scratch[k] * chirp[k];
+        data[k] = inverse ? std::conj(y) : y;
+    }
+}
+
+FFTPlan::FFTPlan(size_t size) : size(size), full(size) {
+    if (size % 2 == 0 && size >= 2) {
+        half = std::make_unique<ComplexFFTPlan>(size / 2);
+        realTwiddles.resize(size / 2);
+        for (size_t k = 0; k < size / 2; ++k) {
+            realTwiddles[k] = std::polar(1.0, -MathUtils::TWO_PI * static_cast<double>(k) / size);
+        }
+    }
+}
+
+const FFTPlan& FFTPlan::get(size_t size) {
+    // Intentionally never destroyed, so plans outlive any static FFT user
+    static auto* cache = new utils::LockFreeCache<size_t, FFTPlan>();
+    return cache->getOrCreate(size, [size] { return FFTPlan(size); });
+}
+
+size_t FFTPlan::getScratchSize() const {
+    size_t complexScratch = full.getScratchSize();
+    size_t realScratch = half ? half->getScratchSize() + size / 2 : size + complexScratch;
+    return std::max(complexScratch, realScratch);
+}
+
+void FFTPlan::forward(Complex* data, Complex* scratch) const {
+    full.forward(data, scratch);
+}
+
+void FFTPlan::inverse(Complex* data, Complex* scratch) const {
+    full.inverse(data, scratch);
+}
+
+void FFTPlan::forwardReal(const float* input, Complex* output, Complex* scratch) const {
+    if (!half) {
+        for (size_t n = 0; n < size; ++n) {
+            scratch[n] = Complex(input[n], 0.0);
+        }
+        full.forward(scratch, scratch + size);
+        std::copy(scratch, scratch + size / 2 + 1, output);
+        return;
+    }
+
+    // Pack even/odd samples as one half-length complex signal, transformed
+    // in place in the output buffer
+    const size_t m = size / 2;
+    for (size_t n = 0; n < m; ++n) {
+        output[n] = Complex(input[2 * n], input[2 * n + 1]);
+    }
+    half->forward(output, scratch);
+
+    // Split: X[k] = E[k] + W^k O[k] and X[m - k] = conj(E[k] - W^k O[k])
+    Complex z0 = output[0];
+    output[0] = Complex(z0.real() + z0.imag(), 0.0);
+    output[m] = Complex(z0.real() - z0.imag(), 0.0);
+
+    for (size_t k = 1; k <= m / 2; ++k) {
+        Complex zk = output[k];
+        Complex zmk = std::conj(output[m - k]);
+        Complex even = 0.5 * (zk + zmk);
+        Complex odd = Complex(0.0, -0.5) * (zk - zmk);
+        Complex rotated = realTwiddles[k] * odd;
+        output[k] = even + rotated;
+        output[m - k] = std::conj(even - rotated);
+    }
+}
+
+void FFTPlan::inverseReal(const Complex* input, float* output, Complex* scratch) const {
+    if (!half) {
+        // Rebuild the Hermitian spectrum and run a full complex inverse
+        scratch[0] = input[0];
+        for (size_t k = 1; k <= size / 2; ++k) {
+            scratch[k] = input[k];
+            scratch[size - k] = std::conj(input[k]);
+        }
+        full.inverse(scratch, scratch + size);
+        for (size_t n = 0; n < size; ++n) {
+            output[n] = static_cast<float>(scratch[n].real());
+        }
+        return;
+    }
+
+    // Undo the split: Z[k] = E[k] + i O[k], with E and O recovered from X[k]
+    // and X[m - k]; the factor of two keeps the result scaled by size
+    const size_t m = size / 2;
+    Complex* packed = scratch;
+    for (size_t k = 0; k < m; ++k) {
+        Complex xk = input[k];
+        Complex xmk = std::conj(input[m - k]);
+        Complex even = xk + xmk;
+        Complex odd = (xk - xmk) * std::conj(realTwiddles[k]);
+        packed[k] = even + Complex(0.0, 1.0) * odd;
+    }
+    half->inverse(packed, scratch + m);
+
+    for (size_t n = 0; n < m; ++n) {
+        output[2 * n] = static_cast<float>(packed[n].real());
+        output[2 * n + 1] = static_cast<float>(packed[n].imag());
+    }
+}
+
+} // namespace signal
+} // namespace song_processor
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "utils/aligned_allocator.hpp"
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace song_processor {
+namespace signal {
+
+// Precomputed tables for complex transforms of one size. Powers of two use
+// an iterative radix-2 kernel; any other size is handled with Bluestein's
+// chirp-z algorithm on top of a power-of-two plan, so every size costs
+// O(N log N). Plans are immutable once built; callers supply scratch space.
+class ComplexFFTPlan {
+public:
+    using Complex = std::complex<double>;
+
+    explicit ComplexFFTPlan(size_t size);
+
+    size_t getSize() const { return size; }
+
+    // Number of Complex values the caller must provide as scratch
+    size_t getScratchSize() const;
+
+    // Unnormalised in-place transforms
+    void forward(Complex* data, Complex* scratch) const;
+    void inverse(Complex* data, Complex* scratch) const;
+
+private:
+    void radix2(Complex* data, bool inverse) const;
+    void bluestein(Complex* data, Complex* scratch, bool inverse) const;
+
+    size_t size;
+    bool powerOfTwo;
+
+    // Radix-2: bit-reversal permutation and per-stage twiddles laid out
+    // contiguously so each butterfly stage reads them in order
+    utils::AlignedVector<uint32_t> bitReverse;
+    utils::AlignedVector<Complex> twiddles;
+
+    // Bluestein: chirp, transformed conjugate chirp and the padded plan
+    utils::AlignedVector<Complex> chirp;
+    utils::AlignedVector<Complex> chirpSpectrum;
+    std::unique_ptr<ComplexFFTPlan> padded;
+};
+
+// Real-input transform of one size. Even sizes run a half-length complex
+// transform on the packed input and split the result with a post-processing
+// pass; odd sizes fall back to a full complex transform.
+class FFTPlan {
+public:
+    using Complex = std::complex<double>;
+
+    explicit FFTPlan(size_t size);
+
+    // Shared plan for size from the process-wide registry. Plans are built
+    // once, never freed, and safe to use concurrently: all mutable state
+    // lives in the caller's scratch buffer. Lookups do not lock. Meant for
+    // the fixed sizes of long-lived users; a one-off transform of an
+    // arbitrary size should build its own plan.
+    static const FFTPlan& get(size_t size);
+
+    size_t getSize() const { return size; }
+    size_t getScratchSize() const;
+
+    // Complex transforms of the full size (unnormalised, in place)
+    void forward(Complex* data, Complex* scratch) const;
+    void inverse(Complex* data, Complex* scratch) const;
+
+    // size real samples -> size/2 + 1 bins
+    void forwardReal(const float* input, Complex* output, Complex* scratch) const;
+
+    // size/2 + 1 bins -> size real samples, unnormalised (scaled by size)
+    void inverseReal(const Complex* input, float* output, Complex* scratch) const;
+
+private:
+    size_t size;
+    ComplexFFTPlan full;
+    std::unique_ptr<ComplexFFTPlan> half;
+    utils::AlignedVector<Complex> realTwiddles; // exp(-2 pi i k / size), k < size/2
+};
+
+} // namespace signal
+} // namespace song_processor
@@ -1,30 +1,166 @@
 #include "signal/filter.hpp"
+#include "signal/convolver.hpp"
+#include "fft_plan.hpp"
+#include "utils/aligned_allocator.hpp"
+#include "utils/filter_design.hpp"
 #include "utils/math_utils.hpp"
+#include "../utils/simd.hpp"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 namespace song_processor {
 namespace signal {
 
+using utils::AlignedVector;
+using utils::MathUtils;
+
+namespace {
+
+using Complex = std::complex<double>;
+
+// Add and remove a tiny offset to flush denormals out of filter state
+// without branching
+constexpr double DENORMAL_GUARD = 1e-30;
+
+// Copy a designed cascade into the filter's section list
+void assignSections(const utils::filter_design::SosDesign& sos, std::vector<BiquadCoefficients>& sections) {
+    sections.resize(sos.sections);
+    for (int k = 0; k < sos.sections; ++k) {
+        const double* c = sos.section(k);
+        sections[k] = BiquadCoefficients{c[0], c[1], c[2], c[4], c[5]};
+    }
+}
+
+// Windowed-sinc low-pass over taps points centred on (taps - 1) / 2,
+// with unity gain at DC. cutoff is in cycles per sample.
+std::vector<double> windowedSinc(double cutoff, const AlignedVector<float>& window) {
+    const size_t taps = window.size();
+    const double centre = static_cast<double>(taps - 1) / 2.0;
+    std::vector<double> h(taps);
+    double sum = 0.0;
+    for (size_t n = 0; n < taps; ++n) {
+        const double x = static_cast<double>(n) - centre;
+        const double sinc = x == 0.0 ? 2.0 * cutoff : std::sin(MathUtils::TWO_PI * cutoff * x) / (MathUtils::PI * x);
+        h[n] = sinc * window[n];
+        sum += h[n];
+    }
+    for (double& value : h) {
+        value /= sum;
+    }
+    return h;
+}
+
+// |sum h[n] e^(-i omega n)|
+double firGain(const std::vector<double>& h, double omega) {
+    Complex sum = 0.0;
+    for (size_t n = 0; n < h.size(); ++n) {
+        sum += h[n] * std::polar(1.0, -omega * static_cast<double>(n));
+    }
+    return std::abs(sum);
+}
+
+// cos and sin of omega_k = pi k / points. Rotation by a fixed step,
+// re-anchored every 64 points so rounding cannot drift.
+void unitCircleGrid(size_t points, std::vector<double>& cosines, std::vector<double>& sines) {
+    constexpr size_t ANCHOR = 64;
+    cosines.resize(points);
+    sines.resize(points);
+    const double step = MathUtils::PI / static_cast<double>(points);
+    const double stepCos = std::cos(step);
+    const double stepSin = std::sin(step);
+    for (size_t k = 0; k < points; ++k) {
+        if (k % ANCHOR == 0) {
+            cosines[k] = std::cos(step * static_cast<double>(k));
+            sines[k] = std::sin(step * static_cast<double>(k));
+        } else {
+            cosines[k] = cosines[k - 1] * stepCos - sines[k - 1] * stepSin;
+            sines[k] = sines[k - 1] * stepCos + cosines[k - 1] * stepSin;
+        }
+    }
+}
+
+// Group delay of a polynomial P(z) = sum c_k z^-k at one grid point from
+// P and its n-weighted form sum k c_k z^-k: Re(weighted / P). Points on a
+// zero of P get no contribution rather than a division blow-up.
+inline double polynomialDelay(double re, double im, double weightedRe, double weightedIm, double floor) {
+    const double norm = re * re + im * im;
+    return norm > floor ? (weightedRe * re + weightedIm * im) / norm : 0.0;
+}
+
+} // namespace
+
 struct Filter::Impl {
     FilterType type = FilterType::LOW_PASS;
     double cutoffFrequency = 1000.0;
     double highCutoffFrequency = 2000.0; // For band-pass/band-stop
     double Q = 1.0;
     int order = 4;
+    int channels = 1;
     double sampleRate = 44100.0;
     
-    // Filter coefficients
-    std::vector<double> bCoeffs; // Numerator coefficients
-    std::vector<double> aCoeffs; // Denominator coefficients
+    // Low- and high-pass response family. The analog prototype depends
+    // only on the family, order and ripple, so it is rebuilt when those
+    // change and a moving cutoff re-runs just the bilinear step.
+    enum class Response { BUTTERWORTH, CHEBYSHEV, ELLIPTIC };
+    Response response = Response::BUTTERWORTH;
+    double rippleDb = 1.0;
+    double stopbandDb = 60.0;
+    utils::filter_design::Prototype prototype;
+    bool prototypeStale = true;
+    
+    // Cascade of second-order sections, applied in order
+    std::vector<BiquadCoefficients> sections;
+    
+    // Transposed Direct Form II state: two values per section per channel,
+    // laid out as [channel][section][s1, s2]
+    std::vector<double> state;
     
-    // State for filtering
-    std::vector<double> xHistory; // Input history
-    std::vector<double> yHistory; // Output history
+    // FIR mode: a non-empty kernel replaces the sections. firDesigned marks
+    // a windowed-sinc design that the parameter setters rebuild;
+    // userKernel marks sections or a kernel set directly, which they leave
+    // alone.
+    static constexpr int MAX_FIR_TAPS = 65535;
+    static constexpr double FIR_KAISER_BETA = 8.6;
+    // Kernels up to this length run entirely in the time domain
+    static constexpr size_t FFT_THRESHOLD = 256;
+    // Frames convolved per step
+    static constexpr size_t FIR_BLOCK = 1024;
+    
+    std::vector<float> fir;
+    bool firDesigned = false;
+    bool userKernel = false;
+    int firTaps = 255;
+    utils::WindowType firWindow = utils::WindowType::BLACKMAN;
+    
+    // The head of the kernel, reversed and zero-padded at the front to a
+    // multiple of 8, is a dot product against the history. Past
+    // FFT_THRESHOLD the head is one convolver block long and the tail taps
+    // go to the convolver, whose one-block latency is exactly the tail's
+    // offset, so the halves sum without extra delay.
+    AlignedVector<float> directKernel;
+    AlignedVector<float> firHistory;   // [channel][directKernel.size() - 1 + FIR_BLOCK]
+    size_t historyStride = 0;
+    Convolver tail;
+    bool hasTail = false;
+    std::vector<float> tailOutput;
+    
+    // Clamp a requested order to what the current type builds: 1 to
+    // filter_design::MAX_ORDER, and even for the band types, whose
+    // transform doubles the prototype order
+    int buildableOrder(int requested) const;
     
     void updateCoefficients();
+    void setResponse(Response family, FilterType filterType, double cutoff, double rate, int filterOrder);
+    void designFir();
+    void prepareFir();
+    void processFir(const float* input, float* output, size_t frames);
     void resetHistory();
+    
+    // Complex response and group delay at omega_k = pi k / points
+    void evaluate(size_t points, std::vector<double>& re, std::vector<double>& im, std::vector<double>& delay) const;
+    void evaluateFir(size_t points, std::vector<double>& re, std::vector<double>& im, std::vector<double>& delay) const;
 };
 
 Filter::Filter() : pImpl(std::make_unique<Impl>()) {}
@@ -32,55 +168,73 @@ Filter::Filter() : pImpl(std::make_unique<Impl>()) {}
 Filter::~Filter() = default;
 
 void Filter::setCutoffFrequency(double freq) {
+    if (pImpl->userKernel) return;
     pImpl->cutoffFrequency = std::max(20.0, std::min(freq, pImpl->sampleRate / 2.0));
     pImpl->updateCoefficients();
 }
 
 void Filter::setQ(double q) {
+    if (pImpl->userKernel) return;
     pImpl->Q = std::max(0.1, std::min(q, 100.0));
     pImpl->updateCoefficients();
 }
 
 void Filter::setOrder(int order) {
-    pImpl->order = std::max(1, std::min(order, 8));
+    if (pImpl->userKernel) return;
+    pImpl->order = pImpl->buildableOrder(order);
+    pImpl->prototypeStale = true;
     pImpl->updateCoefficients();
 }
 
 void Filter::designLowPass(double cutoffFreq, double sampleRate, int order) {
+    pImpl->firDesigned = false;
+    pImpl->userKernel = false;
     pImpl->type = FilterType::LOW_PASS;
     pImpl->cutoffFrequency = cutoffFreq;
     pImpl->sampleRate = sampleRate;
-    pImpl->order = order;
+    pImpl->order = pImpl->buildableOrder(order);
+    pImpl->response = Impl::Response::BUTTERWORTH;
+    pImpl->prototypeStale = true;
     pImpl->updateCoefficients();
 }
 
 void Filter::designHighPass(double cutoffFreq, double sampleRate, int order) {
+    pImpl->firDesigned = false;
+    pImpl->userKernel = false;
     pImpl->type = FilterType::HIGH_PASS;
     pImpl->cutoffFrequency = cutoffFreq;
     pImpl->sampleRate = sampleRate;
-    pImpl->order = order;
+    pImpl->order = pImpl->buildableOrder(order);
+    pImpl->response = Impl::Response::BUTTERWORTH;
+    pImpl->prototypeStale = true;
     pImpl->updateCoefficients();
 }
 
 void Filter::designBandPass(double lowFreq, double highFreq, double sampleRate, int order) {
+    pImpl->firDesigned = false;
+    pImpl->userKernel = false;
     pImpl->type = FilterType::BAND_PASS;
     pImpl->cutoffFrequency = lowFreq;
     pImpl->highCutoffFrequency = highFreq;
     pImpl->sampleRate = sampleRate;
-    pImpl->order = order;
+    pImpl->order = pImpl->buildableOrder(order);
     pImpl->updateCoefficients();
 }
 
 void Filter::designBandStop(double lowFreq, double highFreq, double sampleRate, int order) {
+    pImpl->firDesigned = false;
+    pImpl->userKernel = false;
     pImpl->type = FilterType::BAND_STOP;
     pImpl->cutoffFrequency = lowFreq;
     pImpl->highCutoffFrequency = highFreq;
     pImpl->sampleRate = sampleRate;
-    pImpl->order = order;
+    pImpl->order = pImpl->buildableOrder(order);
     pImpl->updateCoefficients();
 }
 
 void Filter::designNotch(double frequency, double sampleRate, double Q) {
+    pImpl->firDesigned = false;
+    pImpl->userKernel = false;
     pImpl->type = FilterType::NOTCH;
     pImpl->cutoffFrequency = frequency;
     pImpl->sampleRate = sampleRate;
@@ -88,79 +242,165 @@ void Filter::designNotch(double frequency, double sampleRate, double Q) {
     pImpl->updateCoefficients();
 }
 
-std::vector<float> Filter::apply(const std::vector<float>& input) {
-    if (pImpl->bCoeffs.empty() || pImpl->aCoeffs.empty()) {
-        return input; // No filter applied
+void Filter::designChebyshev(FilterType type, double cutoffFreq, double sampleRate, int order, double rippleDb) {
+    if (!(rippleDb > 0.0)) {
+        throw std::invalid_argument("Chebyshev ripple must be positive");
+    }
+    pImpl->rippleDb = rippleDb;
+    pImpl->setResponse(Impl::Response::CHEBYSHEV, type, cutoffFreq, sampleRate, order);
+}
+
+void Filter::designElliptic(FilterType type, double cutoffFreq, double sampleRate, int order,
+                            double rippleDb, double stopbandDb) {
+    if (!(rippleDb > 0.0) || !(stopbandDb > rippleDb)) {
+        throw std::invalid_argument("Elliptic design needs 0 < ripple < stopband attenuation");
     }
+    pImpl->rippleDb = rippleDb;
+    pImpl->stopbandDb = stopbandDb;
+    pImpl->setResponse(Impl::Response::ELLIPTIC, type, cutoffFreq, sampleRate, order);
+}
+
+void Filter::designFirLowPass(double cutoffFreq, double sampleRate, int taps, utils::WindowType window) {
+    pImpl->firDesigned = true;
+    pImpl->userKernel = false;
+    pImpl->type = FilterType::LOW_PASS;
+    pImpl->cutoffFrequency = cutoffFreq;
+    pImpl->sampleRate = sampleRate;
+    pImpl->firTaps = taps;
+    pImpl->firWindow = window;
+    pImpl->updateCoefficients();
+}
+
+void Filter::designFirHighPass(double cutoffFreq, double sampleRate, int taps, utils::WindowType window) {
+    pImpl->firDesigned = true;
+    pImpl->userKernel = false;
+    pImpl->type = FilterType::HIGH_PASS;
+    pImpl->cutoffFrequency = cutoffFreq;
+    pImpl->sampleRate = sampleRate;
+    pImpl->firTaps = taps;
+    pImpl->firWindow = window;
+    pImpl->updateCoefficients();
+}
+
+void Filter::designFirBandPass(double lowFreq, double highFreq, double sampleRate, int taps, utils::WindowType window) {
+    pImpl->firDesigned = true;
+    pImpl->userKernel = false;
+    pImpl->type = FilterType::BAND_PASS;
+    pImpl->cutoffFrequency = lowFreq;
+    pImpl->highCutoffFrequency = highFreq;
+    pImpl->sampleRate = sampleRate;
+    pImpl->firTaps = taps;
+    pImpl->firWindow = window;
+    pImpl->updateCoefficients();
+}
+
+void Filter::designFirBandStop(double lowFreq, double highFreq, double sampleRate, int taps, utils::WindowType window) {
+    pImpl->firDesigned = true;
+    pImpl->userKernel = false;
+    pImpl->type = FilterType::BAND_STOP;
+    pImpl->cutoffFrequency = lowFreq;
+    pImpl->highCutoffFrequency = highFreq;
+    pImpl->sampleRate = sampleRate;
+    pImpl->firTaps = taps;
+    pImpl->firWindow = window;
+    pImpl->updateCoefficients();
+}
+
+std::vector<float> Filter::apply(const std::vector<float>& input) {
+    std::vector<float> output(input);
+    process(input.data(), output.data(), input.size() / pImpl->channels);
+    return output;
+}
+
+void Filter::process(const float* input, float* output, size_t frames) {
+    const size_t channels = static_cast<size_t>(pImpl->channels);
     
-    std::vector<float> output(input.size());
+    if (!pImpl->fir.empty()) {
+        pImpl->processFir(input, output, frames);
+        return;
+    }
     
-    for (size_t i = 0; i < input.size(); ++i) {
-        // Direct Form II implementation
-        double x = static_cast<double>(input[i]);
-        double y = 0.0;
-        
-        // Feed forward (numerator)
-        for (size_t j = 0; j < pImpl->bCoeffs.size(); ++j) {
-            if (i >= j) {
-                y += pImpl->bCoeffs[j] * (i - j < pImpl->xHistory.size() ? pImpl->xHistory[i - j] : x);
-            }
+    if (pImpl->sections.empty()) {
+        if (output != input) {
+            std::copy(input, input + frames * channels, output);
         }
+        return; // No filter applied
+    }
+    
+    const size_t numSections = pImpl->sections.size();
+    
+    for (size_t ch = 0; ch < channels; ++ch) {
+        double* state = pImpl->state.data() + ch * numSections * 2;
+        const float* src = input + ch;
+        float* dst = output + ch;
         
-        // Feed back (denominator)
-        for (size_t j = 1; j < pImpl->aCoeffs.size(); ++j) {
-            if (i >= j) {
-                y -= pImpl->aCoeffs[j] * (i - j < pImpl->yHistory.size() ? pImpl->yHistory[i - j] : 0.0);
+        // Run each section over the whole block with its coefficients and
+        // state held in locals; later sections work in place on the output
+        for (size_t k = 0; k < numSections; ++k) {
+            const BiquadCoefficients& c = pImpl->sections[k];
+            const double b0 = c.b0, b1 = c.b1, b2 = c.b2, a1 = c.a1, a2 = c.a2;
+            double s1 = state[2 * k];
+            double s2 = state[2 * k + 1];
+            
+            for (size_t i = 0; i < frames; ++i) {
+                double x = static_cast<double>(src[i * channels]);
+                double y = b0 * x + s1;
+                s1 = b1 * x - a1 * y + s2;
+                s2 = b2 * x - a2 * y;
+                dst[i * channels] = static_cast<float>(y);
             }
-        }
-        
-        // Normalize by a[0]
-        y /= pImpl->aCoeffs[0];
-        
-        output[i] = static_cast<float>(y);
-        
-        // Update history
-        if (pImpl->xHistory.size() <= i) {
-            pImpl->xHistory.push_back(x);
-        } else {
-            pImpl->xHistory[i] = x;
-        }
-        
-        if (pImpl->yHistory.size() <= i) {
-            pImpl->yHistory.push_back(y);
-        } else {
-            pImpl->yHistory[i] = y;
+            
+            state[2 * k] = (s1 + DENORMAL_GUARD) - DENORMAL_GUARD;
+            state[2 * k + 1] = (s2 + DENORMAL_GUARD) - DENORMAL_GUARD;
+            src = dst;
         }
     }
-    
-    return output;
+}
+
+void Filter::reset() {
+    pImpl->resetHistory();
 }
 
 std::vector<std::complex<double>> Filter::getFrequencyResponse(int numPoints) {
-    std::vector<std::complex<double>> response(numPoints);
+    const size_t points = static_cast<size_t>(std::max(1, numPoints));
+    std::vector<double> re, im, delay;
+    pImpl->evaluate(points, re, im, delay);
     
-    for (int i = 0; i < numPoints; ++i) {
-        double frequency = (static_cast<double>(i) / numPoints) * pImpl->sampleRate / 2.0;
-        double omega = 2.0 * MathUtils::PI * frequency / pImpl->sampleRate;
-        std::complex<double> z = std::exp(std::complex<double>(0, omega));
-        
-        std::complex<double> numerator = 0.0;
-        std::complex<double> denominator = 0.0;
-        
-        // Calculate numerator
-        for (size_t j = 0; j < pImpl->bCoeffs.size(); ++j) {
-            numerator += pImpl->bCoeffs[j] * std::pow(z, -static_cast<double>(j));
-        }
+    std::vector<std::complex<double>> response(points);
+    for (size_t i = 0; i < points; ++i) {
+        response[i] = std::complex<double>(re[i], im[i]);
+    }
+    return response;
+}
+
+FilterAnalysis Filter::analyze(int numPoints) const {
+    const size_t points = static_cast<size_t>(std::max(1, numPoints));
+    std::vector<double> re, im;
+    
+    FilterAnalysis analysis;
+    pImpl->evaluate(points, re, im, analysis.groupDelay);
+    analysis.frequencies.resize(points);
+    analysis.magnitudeDb.resize(points);
+    analysis.phase.resize(points);
+    
+    const double binWidth = pImpl->sampleRate / (2.0 * static_cast<double>(points));
+    double unwrap = 0.0;
+    for (size_t i = 0; i < points; ++i) {
+        analysis.frequencies[i] = binWidth * static_cast<double>(i);
+        // Floor at -300 dB so exact zeros stay finite
+        analysis.magnitudeDb[i] = 10.0 * std::log10(std::max(re[i] * re[i] + im[i] * im[i], 1e-30));
         
-        // Calculate denominator
-        for (size_t j = 0; j < pImpl->aCoeffs.size(); ++j) {
-            denominator += pImpl->aCoeffs[j] * std::pow(z, -static_cast<double>(j));
+        // Unwrap: pick the 2 pi branch nearest the previous point
+        double phase = std::atan2(im[i], re[i]) + unwrap;
+        if (i > 0) {
+            const double jump = phase - analysis.phase[i - 1];
+            const double turns = std::round(jump / MathUtils::TWO_PI);
+            unwrap -= turns * MathUtils::TWO_PI;
+            phase -= turns * MathUtils::TWO_PI;
         }
-        
-        response[i] = numerator / denominator;
+        analysis.phase[i] = phase;
     }
-    
-    return response;
+    return analysis;
 }
 
 FilterType Filter::getType() const {
@@ -179,92 +419,408 @@ int Filter::getOrder() const {
     return pImpl->order;
 }
 
+void Filter::setChannels(int channels) {
+    pImpl->channels = std::max(1, channels);
+    pImpl->resetHistory();
+}
+
+int Filter::getChannels() const {
+    return pImpl->channels;
+}
+
+void Filter::setSections(const std::vector<BiquadCoefficients>& sections) {
+    pImpl->firDesigned = false;
+    pImpl->userKernel = true;
+    pImpl->fir.clear();
+    pImpl->prepareFir();
+    pImpl->sections = sections;
+    pImpl->resetHistory();
+}
+
+void Filter::setFirCoefficients(const std::vector<float>& coefficients) {
+    if (coefficients.size() > static_cast<size_t>(Impl::MAX_FIR_TAPS)) {
+        throw std::invalid_argument("FIR kernel longer than " + std::to_string(Impl::MAX_FIR_TAPS) + " taps");
+    }
+    pImpl->firDesigned = false;
+    pImpl->userKernel = true;
+    pImpl->fir = coefficients;
+    pImpl->sections.clear();
+    pImpl->prepareFir();
+    pImpl->resetHistory();
+}
+
+std::vector<BiquadCoefficients> Filter::getSections() const {
+    return pImpl->sections;
+}
+
+std::vector<float> Filter::getFirCoefficients() const {
+    return pImpl->fir;
+}
+
+bool Filter::isFir() const {
+    return !pImpl->fir.empty();
+}
+
 void Filter::Impl::updateCoefficients() {
-    // Reset history when coefficients change
-    resetHistory();
-    
-    // Calculate normalized frequency
-    double normalizedFreq = cutoffFrequency / sampleRate;
-    double normalizedHighFreq = highCutoffFrequency / sampleRate;
+    const double fs = sampleRate;
+    const double nyquist = fs / 2.0;
+    const double low = MathUtils::clamp(cutoffFrequency, 1.0, nyquist * 0.99);
+    const double high = MathUtils::clamp(std::max(highCutoffFrequency, low * 1.01), 1.0, nyquist * 0.995);
     
-    // Clear previous coefficients
-    bCoeffs.clear();
-    aCoeffs.clear();
+    if (firDesigned) {
+        // The history holds past input, not output, so a short kernel that
+        // keeps its length can be swapped under it. The FFT tail's state
+        // is tied to its kernel, so long kernels start over.
+        const size_t oldLength = directKernel.size();
+        const bool hadTail = hasTail;
+        designFir();
+        prepareFir();
+        if (hasTail || hadTail || directKernel.size() != oldLength ||
+            firHistory.size() != historyStride * static_cast<size_t>(channels)) {
+            resetHistory();
+        }
+        return;
+    }
+    if (!fir.empty()) {
+        fir.clear();
+        prepareFir();
+    }
     
     switch (type) {
-        case FilterType::LOW_PASS: {
-            // Simple first-order low-pass filter
-            double alpha = 1.0 / (1.0 + 2.0 * MathUtils::PI * normalizedFreq);
-            bCoeffs = {alpha};
-            aCoeffs = {1.0, alpha - 1.0};
+        case FilterType::LOW_PASS:
+        case FilterType::HIGH_PASS: {
+            // Order n: n/2 biquads plus a first-order section if odd
+            namespace design = utils::filter_design;
+            if (prototypeStale) {
+                switch (response) {
+                    case Response::BUTTERWORTH: prototype = design::butterworthPrototype(order); break;
+                    case Response::CHEBYSHEV: prototype = design::chebyshevPrototype(order, rippleDb); break;
+                    case Response::ELLIPTIC: prototype = design::ellipticPrototype(order, rippleDb, stopbandDb); break;
+                }
+                prototypeStale = false;
+            }
+            
+            assignSections(design::digitise(prototype, low, fs, type == FilterType::HIGH_PASS), sections);
             break;
         }
         
-        case FilterType::HIGH_PASS: {
-            // Simple first-order high-pass filter
-            double alpha = 1.0 / (1.0 + 2.0 * MathUtils::PI * normalizedFreq);
-            bCoeffs = {1.0 - alpha};
-            aCoeffs = {1.0, alpha - 1.0};
+        case FilterType::BAND_PASS:
+        case FilterType::BAND_STOP: {
+            // Band transforms double the prototype order, so an order n
+            // band filter (n even) uses an n/2 prototype and yields n/2 biquads
+            namespace design = utils::filter_design;
+            assignSections(design::digitiseBand(design::butterworthPrototype(order / 2), low, high, fs,
+                                                type == FilterType::BAND_STOP),
+                           sections);
             break;
         }
         
-        case FilterType::BAND_PASS: {
-            // Simple band-pass filter
-            double centerFreq = (cutoffFrequency + highCutoffFrequency) / 2.0;
-            double bandwidth = highCutoffFrequency - cutoffFrequency;
-            double normalizedCenter = centerFreq / sampleRate;
-            double normalizedBandwidth = bandwidth / sampleRate;
-            
-            double alpha = std::tan(MathUtils::PI * normalizedBandwidth / 2.0);
-            double beta = std::cos(2.0 * MathUtils::PI * normalizedCenter);
-            
+        case FilterType::NOTCH: {
+            // Single notch biquad (RBJ cookbook)
+            double omega = 2.0 * MathUtils::PI * low / fs;
+            double alpha = std::sin(omega) / (2.0 * Q);
             double a0 = 1.0 + alpha;
-            bCoeffs = {alpha / a0, 0.0, -alpha / a0};
-            aCoeffs = {1.0, -2.0 * beta / a0, (1.0 - alpha) / a0};
+            
+            BiquadCoefficients c;
+            c.b0 = 1.0 / a0;
+            c.b1 = -2.0 * std::cos(omega) / a0;
+            c.b2 = 1.0 / a0;
+            c.a1 = c.b1;
+            c.a2 = (1.0 - alpha) / a0;
+            sections = {c};
             break;
         }
+    }
+    
+    // Keep the state when only the coefficient values moved, so a cutoff
+    // swept block by block does not click
+    if (state.size() != sections.size() * 2 * static_cast<size_t>(channels)) {
+        resetHistory();
+    }
+}
+
+int Filter::Impl::buildableOrder(int requested) const {
+    const int n = MathUtils::clamp(requested, 1, utils::filter_design::MAX_ORDER);
+    if (type == FilterType::BAND_PASS || type == FilterType::BAND_STOP) {
+        return n + (n & 1);
+    }
+    return n;
+}
+
+void Filter::Impl::setResponse(Response family, FilterType filterType, double cutoff, double rate, int filterOrder) {
+    if (filterType != FilterType::LOW_PASS && filterType != FilterType::HIGH_PASS) {
+        throw std::invalid_argument("Chebyshev and elliptic designs are low- or high-pass only");
+    }
+    firDesigned = false;
+    userKernel = false;
+    response = family;
+    type = filterType;
+    cutoffFrequency = cutoff;
+    sampleRate = rate;
+    order = buildableOrder(filterOrder);
+    prototypeStale = true;
+    updateCoefficients();
+}
+
+void Filter::Impl::designFir() {
+    const double nyquist = sampleRate / 2.0;
+    const double low = MathUtils::clamp(cutoffFrequency, 1.0, nyquist * 0.99) / sampleRate;
+    const double high = MathUtils::clamp(std::max(highCutoffFrequency, cutoffFrequency * 1.01), 1.0, nyquist * 0.995) / sampleRate;
+    
+    // Odd length: high-pass and band-stop need a centre tap, and a whole
+    // sample delay keeps every design aligned with the dry signal
+    const int taps = MathUtils::clamp(firTaps, 3, MAX_FIR_TAPS) | 1;
+    const size_t centre = static_cast<size_t>(taps - 1) / 2;
+    const double beta = firWindow == utils::WindowType::KAISER ? FIR_KAISER_BETA : 0.0;
+    const AlignedVector<float>& window = MathUtils::getWindow(firWindow, taps, beta);
+    
+    std::vector<double> h;
+    switch (type) {
+        case FilterType::LOW_PASS:
+            h = windowedSinc(low, window);
+            break;
         
+        case FilterType::HIGH_PASS:
+            // Spectral inversion of the low-pass
+            h = windowedSinc(low, window);
+            for (double& value : h) value = -value;
+            h[centre] += 1.0;
+            break;
+        
+        case FilterType::BAND_PASS:
         case FilterType::BAND_STOP: {
-            // Simple band-stop filter
-            double centerFreq = (cutoffFrequency + highCutoffFrequency) / 2.0;
-            double bandwidth = highCutoffFrequency - cutoffFrequency;
-            double normalizedCenter = centerFreq / sampleRate;
-            double normalizedBandwidth = bandwidth / sampleRate;
-            
-            double alpha = std::tan(MathUtils::PI * normalizedBandwidth / 2.0);
-            double beta = std::cos(2.0 * MathUtils::PI * normalizedCenter);
+            // Difference of two low-passes, unity gain mid-band
+            h = windowedSinc(high, window);
+            const std::vector<double> lower = windowedSinc(low, window);
+            for (size_t i = 0; i < h.size(); ++i) h[i] -= lower[i];
+            const double gain = firGain(h, MathUtils::PI * (low + high));
+            for (double& value : h) value /= gain;
             
-            double a0 = 1.0 + alpha;
-            bCoeffs = {1.0 / a0, -2.0 * beta / a0, 1.0 / a0};
-            aCoeffs = {1.0, -2.0 * beta / a0, (1.0 - alpha) / a0};
+            if (type == FilterType::BAND_STOP) {
+                for (double& value : h) value = -value;
+                h[centre] += 1.0;
+            }
             break;
         }
         
-        case FilterType::NOTCH: {
-            // Notch filter (band-stop at specific frequency)
-            double normalizedFreq = cutoffFrequency / sampleRate;
-            double alpha = std::tan(MathUtils::PI * normalizedFreq / Q);
-            
-            double a0 = 1.0 + alpha;
-            bCoeffs = {1.0 / a0, -2.0 * std::cos(2.0 * MathUtils::PI * normalizedFreq) / a0, 1.0 / a0};
-            aCoeffs = {1.0, -2.0 * std::cos(2.0 * MathUtils::PI * normalizedFreq) / a0, (1.0 - alpha) / a0};
+        case FilterType::NOTCH:
+            // No FIR designer sets this type
+            h = windowedSinc(low, window);
             break;
+    }
+    
+    fir.assign(h.begin(), h.end());
+    sections.clear();
+}
+
+void Filter::Impl::prepareFir() {
+    const size_t taps = fir.size();
+    hasTail = taps > FFT_THRESHOLD;
+    
+    // Head length: the whole kernel, or one convolver block that grows
+    // with the kernel so the FFT tail keeps a sensible partition count
+    size_t head = taps;
+    if (hasTail) {
+        const int root = static_cast<int>(std::sqrt(static_cast<double>(taps)));
+        head = static_cast<size_t>(MathUtils::clamp(MathUtils::nextPowerOfTwo(root) * 2, 64, 1024));
+        head = std::min(head, taps);
+    }
+    
+    const size_t padded = (head + 7) & ~size_t(7);
+    directKernel.assign(padded, 0.0f);
+    for (size_t k = 0; k < head; ++k) {
+        directKernel[padded - 1 - k] = fir[k];
+    }
+    
+    if (hasTail) {
+        tail.setChannels(channels);
+        tail.setImpulseResponse(fir.data() + head, taps - head, 1, static_cast<int>(head));
+    } else {
+        tail.clear();
+    }
+}
+
+void Filter::Impl::processFir(const float* input, float* output, size_t frames) {
+    const size_t numChannels = static_cast<size_t>(channels);
+    const size_t length = directKernel.size();
+    const size_t reach = length - 1; // Past frames the head reads
+    
+    for (size_t start = 0; start < frames; start += FIR_BLOCK) {
+        const size_t count = std::min(FIR_BLOCK, frames - start);
+        const float* in = input + start * numChannels;
+        float* out = output + start * numChannels;
+        
+        // Take the input before any output is written, since they may alias
+        for (size_t ch = 0; ch < numChannels; ++ch) {
+            float* row = firHistory.data() + ch * historyStride + reach;
+            for (size_t i = 0; i < count; ++i) {
+                row[i] = in[i * numChannels + ch];
+            }
+        }
+        if (hasTail) {
+            tail.process(in, tailOutput.data(), count);
+        }
+        
+        for (size_t ch = 0; ch < numChannels; ++ch) {
+            float* row = firHistory.data() + ch * historyStride;
+            for (size_t i = 0; i < count; ++i) {
+                float y = utils::dotProduct(directKernel.data(), row + i, length);
+                if (hasTail) y += tailOutput[i * numChannels + ch];
+                out[i * numChannels + ch] = y;
+            }
+            std::copy(row + count, row + count + reach, row);
         }
     }
+}
+
+void Filter::Impl::evaluate(size_t points, std::vector<double>& re, std::vector<double>& im,
+                            std::vector<double>& delay) const {
+    if (!fir.empty()) {
+        evaluateFir(points, re, im, delay);
+        return;
+    }
     
-    // Ensure we have at least one coefficient
-    if (bCoeffs.empty()) {
-        bCoeffs = {1.0};
+    re.assign(points, 1.0);
+    im.assign(points, 0.0);
+    delay.assign(points, 0.0);
+    if (sections.empty()) return;
+    
+    std::vector<double> cosines, sines;
+    unitCircleGrid(points, cosines, sines);
+    
+    // The cascade's numerator and denominator are products of the section
+    // polynomials. Each is carried along with its n-weighted version by the
+    // product rule, so the delay needs one division per point, not per
+    // section, and the loop has no transcendental calls.
+    double numeratorScale = 1.0;
+    double denominatorScale = 1.0;
+    for (const auto& c : sections) {
+        numeratorScale *= c.b0 * c.b0 + c.b1 * c.b1 + c.b2 * c.b2;
+        denominatorScale *= 1.0 + c.a1 * c.a1 + c.a2 * c.a2;
     }
-    if (aCoeffs.empty()) {
-        aCoeffs = {1.0};
+    const double numeratorFloor = 1e-24 * numeratorScale;
+    const double denominatorFloor = 1e-24 * denominatorScale;
+    
+    // Points go in blocks held in local arrays with sections outer, so the
+    // inner iterations are independent and pipeline instead of waiting on
+    // one point's chain of complex products
+    constexpr size_t BLOCK = 64;
+    for (size_t start = 0; start < points; start += BLOCK) {
+        const size_t count = std::min(BLOCK, points - start);
+        double c1[BLOCK], s1[BLOCK], c2[BLOCK], s2[BLOCK];
+        double nr[BLOCK], ni[BLOCK], nwr[BLOCK], nwi[BLOCK];
+        double dr[BLOCK], di[BLOCK], dwr[BLOCK], dwi[BLOCK];
+        for (size_t j = 0; j < count; ++j) {
+            c1[j] = cosines[start + j];
+            s1[j] = sines[start + j];
+            c2[j] = c1[j] * c1[j] - s1[j] * s1[j];
+            s2[j] = 2.0 * c1[j] * s1[j];
+            nr[j] = dr[j] = 1.0;
+            ni[j] = di[j] = nwr[j] = nwi[j] = dwr[j] = dwi[j] = 0.0;
+        }
+        
+        for (const auto& c : sections) {
+            const double b0 = c.b0, b1 = c.b1, b2 = c.b2, a1 = c.a1, a2 = c.a2;
+            for (size_t j = 0; j < count; ++j) {
+                // B(z), A(z) and their n-weighted forms at z^-1 = c1 - i s1
+                const double br = b0 + b1 * c1[j] + b2 * c2[j];
+                const double bi = -(b1 * s1[j] + b2 * s2[j]);
+                const double bwr = b1 * c1[j] + 2.0 * b2 * c2[j];
+                const double bwi = -(b1 * s1[j] + 2.0 * b2 * s2[j]);
+                const double ar = 1.0 + a1 * c1[j] + a2 * c2[j];
+                const double ai = -(a1 * s1[j] + a2 * s2[j]);
+                const double awr = a1 * c1[j] + 2.0 * a2 * c2[j];
+                const double awi = -(a1 * s1[j] + 2.0 * a2 * s2[j]);
+                
+                // (N B)w = Nw B + N Bw, then N B; likewise for D and A
+                const double tr = nwr[j] * br - nwi[j] * bi + nr[j] * bwr - ni[j] * bwi;
+                const double ti = nwr[j] * bi + nwi[j] * br + nr[j] * bwi + ni[j] * bwr;
+                const double pr = nr[j] * br - ni[j] * bi;
+                const double pi = nr[j] * bi + ni[j] * br;
+                nwr[j] = tr;
+                nwi[j] = ti;
+                nr[j] = pr;
+                ni[j] = pi;
+                
+                const double ur = dwr[j] * ar - dwi[j] * ai + dr[j] * awr - di[j] * awi;
+                const double ui = dwr[j] * ai + dwi[j] * ar + dr[j] * awi + di[j] * awr;
+                const double qr = dr[j] * ar - di[j] * ai;
+                const double qi = dr[j] * ai + di[j] * ar;
+                dwr[j] = ur;
+                dwi[j] = ui;
+                dr[j] = qr;
+                di[j] = qi;
+            }
+        }
+        
+        for (size_t j = 0; j < count; ++j) {
+            const double dn = dr[j] * dr[j] + di[j] * di[j];
+            re[start + j] = (nr[j] * dr[j] + ni[j] * di[j]) / dn;
+            im[start + j] = (ni[j] * dr[j] - nr[j] * di[j]) / dn;
+            delay[start + j] = polynomialDelay(nr[j], ni[j], nwr[j], nwi[j], numeratorFloor)
+                             - polynomialDelay(dr[j], di[j], dwr[j], dwi[j], denominatorFloor);
+        }
+    }
+}
+
+void Filter::Impl::evaluateFir(size_t points, std::vector<double>& re, std::vector<double>& im,
+                               std::vector<double>& delay) const {
+    // DTFT samples at pi k / points are the bins of a 2 * points FFT.
+    // Longer kernels fold modulo the transform size, which leaves those
+    // samples unchanged. h[n] and n h[n], the delay numerator, share one
+    // double-precision complex transform as its real and imaginary parts.
+    const size_t size = 2 * points;
+    // Powers of two are a small bounded set and worth sharing; any other
+    // grid builds a plan for this call rather than pinning one forever
+    std::unique_ptr<FFTPlan> local;
+    if (!MathUtils::isPowerOfTwo(static_cast<int>(size))) {
+        local = std::make_unique<FFTPlan>(size);
+    }
+    const FFTPlan& plan = local ? *local : FFTPlan::get(size);
+    std::vector<Complex> data(size, Complex(0.0));
+    std::vector<Complex> scratch(plan.getScratchSize());
+    double energy = 0.0;
+    for (size_t n = 0; n < fir.size(); ++n) {
+        const double tap = fir[n];
+        data[n % size] += Complex(tap, static_cast<double>(n) * tap);
+        energy += tap * tap;
+    }
+    plan.forward(data.data(), scratch.data());
+    
+    re.resize(points);
+    im.resize(points);
+    delay.resize(points);
+    const double floor = 1e-24 * energy;
+    for (size_t k = 0; k < points; ++k) {
+        // Split the two real sequences' spectra by conjugate symmetry
+        const Complex mirror = std::conj(data[(size - k) % size]);
+        const Complex response = 0.5 * (data[k] + mirror);
+        const Complex weighted = Complex(0.0, -0.5) * (data[k] - mirror);
+        re[k] = response.real();
+        im[k] = response.imag();
+        delay[k] = polynomialDelay(re[k], im[k], weighted.real(), weighted.imag(), floor);
     }
 }
 
 void Filter::Impl::resetHistory() {
-    xHistory.clear();
-    yHistory.clear();
+    state.assign(sections.size() * 2 * channels, 0.0);
+    
+    if (fir.empty()) {
+        firHistory.clear();
+        tailOutput.clear();
+        return;
+    }
+    historyStride = directKernel.size() - 1 + FIR_BLOCK;
+    firHistory.assign(historyStride * channels, 0.0f);
+    tailOutput.assign(FIR_BLOCK * channels, 0.0f);
+    if (hasTail) {
+        if (tail.getChannels() != channels) {
+            tail.setChannels(channels);
+        } else {
+            tail.reset();
+        }
+    }
 }
 
 } // namespace signal
-} // namespace song_processor 
\ No newline at end of file
+} // namespace song_processor
@@ -0,0 +1,300 @@
+#include "signal/resampler.hpp"
+#include "utils/aligned_allocator.hpp"
+#include "utils/math_utils.hpp"
+#include "../utils/simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+
+namespace song_processor {
+namespace signal {
+
+using utils::MathUtils;
+
+namespace {
+
+struct QualitySettings {
+    int taps;        // Per phase at unity ratio
+    double rolloff;  // Passband edge as a fraction of the lower Nyquist
+    double beta;     // Kaiser window shape
+};
+
+QualitySettings settingsFor(ResampleQuality quality) {
+    switch (quality) {
+        case ResampleQuality::FAST: return {16, 0.76, 6.0};
+        case ResampleQuality::MEDIUM: return {48, 0.88, 8.0};
+        case ResampleQuality::HIGH: return {96, 0.92, 10.0};
+    }
+    return {96, 0.92, 10.0};
+}
+
+} // namespace
+
+struct Resampler::Impl {
+    static constexpr int MAX_PHASES = 4096;
+    static constexpr int MAX_TAPS = 1024;
+    // Input frames de-interleaved into the history per step
+    static constexpr size_t CHUNK_FRAMES = 1024;
+
+    int inputRate = 44100;
+    int outputRate = 48000;
+    int channels = 1;
+    ResampleQuality quality = ResampleQuality::HIGH;
+
+    // Ratio L/M in lowest terms; L is also the number of phases
+    int64_t up = 1;
+    int64_t down = 1;
+    size_t taps = 8;
+
+    // Phase p occupies taps coefficients at p * taps, stored oldest-input
+    // first so each output is a forward dot product over the history
+    utils::AlignedVector<float> table;
+
+    // One row per channel: history[c * rowSize + i] holds input frame
+    // rowStart + i, for the filled frames present
+    utils::AlignedVector<float> history;
+    size_t rowSize = 0;
+    size_t filled = 0;
+    int64_t rowStart = 0;
+
+    // Next output: newest input frame it reads and its polyphase branch
+    int64_t nextBase = 0;
+    int64_t phase = 0;
+
+    uint64_t inputCount = 0;
+    uint64_t outputCount = 0;
+
+    // Equal rates copy straight through rather than band-limiting
+    bool isPassthrough() const { return up == down; }
+
+    void configure();
+    void buildTable();
+    void clearState();
+    void append(const float* input, size_t frames);
+    size_t generate(float* output, uint64_t limit);
+    void compact();
+};
+
+void Resampler::Impl::configure() {
+    const int64_t divisor = std::gcd(static_cast<int64_t>(inputRate), static_cast<int64_t>(outputRate));
+    up = outputRate / divisor;
+    down = inputRate / divisor;
+    if (up > MAX_PHASES) {
+        throw std::invalid_argument("Resampling ratio " + std::to_string(outputRate) + "/" +
+                                    std::to_string(inputRate) + " needs too many polyphase branches");
+    }
+
+    // Downsampling lowers the cutoff, widening the sinc; keep the same
+    // number of zero crossings by scaling the taps
+    const QualitySettings settings = settingsFor(quality);
+    const double ratio = std::min(1.0, static_cast<double>(up) / down);
+    size_t wanted = static_cast<size_t>(std::ceil(settings.taps / ratio));
+    taps = std::min<size_t>((wanted + 7) & ~size_t(7), MAX_TAPS);
+
+    buildTable();
+    rowSize = taps + CHUNK_FRAMES;
+    history.assign(rowSize * channels, 0.0f);
+    clearState();
+}
+
+void Resampler::Impl::buildTable() {
+    const QualitySettings settings = settingsFor(quality);
+    const size_t phases = static_cast<size_t>(up);
+    const size_t length = phases * taps;
+    const double centre = static_cast<double>(length) / 2.0;
+
+    // Cutoff in cycles per sample at the upsampled rate L * inputRate
+    const double cutoff = settings.rolloff * 0.5 * std::min(1.0, static_cast<double>(up) / down) / up;
+
+    // One point longer than the prototype so the window peaks on the centre
+    const std::vector<float> window = MathUtils::kaiserWindow(static_cast<int>(length) + 1, settings.beta);
+
+    table.assign(length, 0.0f);
+    std::vector<double> branch(taps);
+    for (size_t p = 0; p < phases; ++p) {
+        double sum = 0.0;
+        for (size_t k = 0; k < taps; ++k) {
+            const size_t n = p + k * phases;
+            const double x = 2.0 * cutoff * (static_cast<double>(n) - centre);
+            const double sinc = x == 0.0 ? 1.0 : std::sin(MathUtils::PI * x) / (MathUtils::PI * x);
+            branch[k] = sinc * window[n];
+            sum += branch[k];
+        }
+
+        // Each branch gets unity DC gain, so no phase-dependent ripple
+        // appears on steady signals
+        float* row = table.data() + p * taps;
+        for (size_t k = 0; k < taps; ++k) {
+            row[taps - 1 - k] = static_cast<float>(branch[k] / sum);
+        }
+    }
+}
+
+void Resampler::Impl::clearState() {
+    std::fill(history.begin(), history.end(), 0.0f);
+
+    // Start with taps frames of silence before the signal, and centre the
+    // first output on input frame 0
+    filled = taps;
+    rowStart = -static_cast<int64_t>(taps);
+    nextBase = static_cast<int64_t>(taps / 2);
+    phase = 0;
+    inputCount = 0;
+    outputCount = 0;
+}
+
+void Resampler::Impl::append(const float* input, size_t frames) {
+    for (int c = 0; c < channels; ++c) {
+        float* row = history.data() + c * rowSize + filled;
+        if (input) {
+            for (size_t i = 0; i < frames; ++i) {
+                row[i] = input[i * channels + c];
+            }
+        } else {
+            std::fill(row, row + frames, 0.0f);
+        }
+    }
+    filled += frames;
+}
+
+size_t Resampler::Impl::generate(float* output, uint64_t limit) {
+    const int64_t available = rowStart + static_cast<int64_t>(filled);
+    size_t written = 0;
+
+    while (nextBase < available && outputCount < limit) {
+        const size_t offset = static_cast<size_t>(nextBase - static_cast<int64_t>(taps) + 1 - rowStart);
+        const float* coefficients = table.data() + phase * taps;
+        for (int c = 0; c < channels; ++c) {
+            output[written * channels + c] = utils::dotProduct(coefficients, history.data() + c * rowSize + offset, taps);
+        }
+        ++written;
+        ++outputCount;
+
+        phase += down;
+        while (phase >= up) {
+            phase -= up;
+            ++nextBase;
+        }
+    }
+    return written;
+}
+
+void Resampler::Impl::compact() {
+    // Every later output starts at or after available - taps
+    const size_t keep = std::min(filled, taps);
+    const size_t drop = filled - keep;
+    for (int c = 0; c < channels; ++c) {
+        float* row = history.data() + c * rowSize;
+        std::copy(row + drop, row + filled, row);
+    }
+    rowStart += static_cast<int64_t>(drop);
+    filled = keep;
+}
+
+Resampler::Resampler(int inputRate, int outputRate, int channels, ResampleQuality quality)
+    : pImpl(std::make_unique<Impl>()) {
+    pImpl->channels = std::max(1, channels);
+    pImpl->quality = quality;
+    setRates(inputRate, outputRate);
+}
+
+Resampler::~Resampler() = default;
+
+void Resampler::setRates(int inputRate, int outputRate) {
+    if (inputRate <= 0 || outputRate <= 0) {
+        throw std::invalid_argument("Sample rates must be positive");
+    }
+    pImpl->inputRate = inputRate;
+    pImpl->outputRate = outputRate;
+    pImpl->configure();
+}
+
+void Resampler::setChannels(int channels) {
+    pImpl->channels = std::max(1, channels);
+    pImpl->configure();
+}
+
+void Resampler::setQuality(ResampleQuality quality) {
+    pImpl->quality = quality;
+    pImpl->configure();
+}
+
+size_t Resampler::process(const float* input, size_t frames, float* output) {
+    auto& impl = *pImpl;
+    if (impl.isPassthrough()) {
+        std::copy(input, input + frames * impl.channels, output);
+        impl.inputCount += frames;
+        impl.outputCount += frames;
+        return frames;
+    }
+
+    size_t written = 0;
+    for (size_t start = 0; start < frames; start += Impl::CHUNK_FRAMES) {
+        const size_t count = std::min(Impl::CHUNK_FRAMES, frames - start);
+        impl.append(input + start * impl.channels, count);
+        impl.inputCount += count;
+        written += impl.generate(output + written * impl.channels, UINT64_MAX);
+        impl.compact();
+    }
+    return written;
+}
+
+size_t Resampler::flush(float* output) {
+    auto& impl = *pImpl;
+    const uint64_t target = (impl.inputCount * impl.up + impl.down - 1) / impl.down;
+    size_t written = 0;
+
+    while (impl.outputCount < target) {
+        impl.append(nullptr, Impl::CHUNK_FRAMES);
+        written += impl.generate(output + written * impl.channels, target);
+        impl.compact();
+    }
+    return written;
+}
+
+std::vector<float> Resampler::apply(const std::vector<float>& input) {
+    reset();
+    const size_t frames = input.size() / pImpl->channels;
+    std::vector<float> output((getMaxOutputFrames(frames) + getMaxOutputFrames(getLatency())) * pImpl->channels);
+
+    size_t written = process(input.data(), frames, output.data());
+    written += flush(output.data() + written * pImpl->channels);
+    output.resize(written * pImpl->channels);
+
+    reset();
+    return output;
+}
+
+void Resampler::reset() {
+    pImpl->clearState();
+}
+
+size_t Resampler::getMaxOutputFrames(size_t inputFrames) const {
+    return static_cast<size_t>((inputFrames * pImpl->up + pImpl->down - 1) / pImpl->down) + 1;
+}
+
+int Resampler::getLatency() const {
+    if (pImpl->isPassthrough()) return 0;
+    return static_cast<int>(pImpl->taps / 2);
+}
+
+int Resampler::getInputRate() const {
+    return pImpl->inputRate;
+}
+
+int Resampler::getOutputRate() const {
+    return pImpl->outputRate;
+}
+
+int Resampler::getChannels() const {
+    return pImpl->channels;
+}
+
+ResampleQuality Resampler::getQuality() const {
+    return pImpl->quality;
+}
+
+} // namespace signal
+} // namespace song_processor
@@ -0,0 +1,410 @@
+#include "signal/spectrum_analyzer.hpp"
+#include "signal/fft.hpp"
+#include "utils/math_utils.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace song_processor {
+namespace signal {
+
+using utils::MathUtils;
+using utils::WindowType;
+
+struct SpectrumAnalyzer::Impl {
+    static constexpr double KAISER_BETA = 8.6;
+    static constexpr double MAX_OVERLAP = 0.95;
+
+    int fftSize = 2048;
+    std::string windowName = "hanning";
+    WindowType windowType = WindowType::HANNING;
+    double overlap = 0.5;
+    double sampleRate = 44100.0;
+    int hopSize = 1024;
+
+    FFT fft;
+    const utils::AlignedVector<float>* window = nullptr;
+    double amplitudeScale = 1.0; // Maps a full-scale sine to magnitude 1
+
+    // Streaming state: the last fftSize samples, oldest at writePos
+    std::vector<float> ring;
+    size_t writePos = 0;
+    int samplesSinceFrame = 0;
+
+    // Preallocated frame buffers and the most recent spectrum
+    std::vector<float> frame;
+    std::vector<std::complex<double>> bins;
+    SpectrumData current;
+
+    void configure();
+    Spectrogram spectrogram(const float* input, size_t length, utils::ThreadPool& pool, size_t ranges) const;
+    void computeFrame(const float* samples, SpectrumData& target);
+    void computeRingFrame();
+    void transformFrame(SpectrumData& target);
+    int numBins() const { return fftSize / 2 + 1; }
+    
+    // DC and Nyquist have no mirrored twin and count once
+    double binScale(int k) const { return (k == 0 || 2 * k == fftSize) ? 0.5 * amplitudeScale : amplitudeScale; }
+};
+
+SpectrumAnalyzer::SpectrumAnalyzer() : pImpl(std::make_unique<Impl>()) {
+    pImpl->configure();
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() = default;
+
+SpectrumData SpectrumAnalyzer::analyze(const std::vector<float>& input) {
+    // Average magnitudes over hop-spaced frames (Welch); the phases are
+    // those of the final frame. Short input is zero-padded to one frame.
+    auto& impl = *pImpl;
+    const size_t size = static_cast<size_t>(impl.fftSize);
+    const size_t hop = static_cast<size_t>(impl.hopSize);
+
+    SpectrumData result = impl.current;
+    SpectrumData frameSpectrum = impl.current;
+    std::fill(result.magnitudes.begin(), result.magnitudes.end(), 0.0);
+
+    std::vector<float> padded;
+    const float* samples = input.data();
+    size_t length = input.size();
+    if (length < size) {
+        padded.assign(size, 0.0f);
+        std::copy(input.begin(), input.end(), padded.begin());
+        samples = padded.data();
+        length = size;
+    }
+
+    size_t frames = 0;
+    for (size_t start = 0; start + size <= length; start += hop, ++frames) {
+        impl.computeFrame(samples + start, frameSpectrum);
+        for (size_t k = 0; k < result.magnitudes.size(); ++k) {
+            result.magnitudes[k] += frameSpectrum.magnitudes[k];
+        }
+    }
+
+    for (double& magnitude : result.magnitudes) {
+        magnitude /= static_cast<double>(frames);
+    }
+    result.phases = frameSpectrum.phases;
+    return result;
+}
+
+Spectrogram SpectrumAnalyzer::computeSpectrogram(const std::vector<float>& input, int numThreads) {
+    return computeSpectrogram(input.data(), input.size(), numThreads);
+}
+
+Spectrogram SpectrumAnalyzer::computeSpectrogram(const float* input, size_t length, int numThreads) {
+    utils::ThreadPool& pool = utils::ThreadPool::shared();
+    const size_t ranges = numThreads > 0 ? static_cast<size_t>(numThreads) : pool.getThreadCount() + 1;
+    return pImpl->spectrogram(input, length, pool, ranges);
+}
+
+Spectrogram SpectrumAnalyzer::computeSpectrogram(const float* input, size_t length, utils::ThreadPool& pool) {
+    return pImpl->spectrogram(input, length, pool, pool.getThreadCount() + 1);
+}
+
+Spectrogram SpectrumAnalyzer::Impl::spectrogram(const float* input, size_t length, utils::ThreadPool& pool,
+                                                size_t ranges) const {
+    const size_t size = static_cast<size_t>(fftSize);
+    const size_t hop = static_cast<size_t>(hopSize);
+
+    Spectrogram result;
+    result.fftSize = fftSize;
+    result.hopSize = hopSize;
+    result.numBins = numBins();
+    result.sampleRate = sampleRate;
+    if (length == 0) return result;
+
+    result.numFrames = static_cast<int>(length <= size ? 1 : 1 + (length - size + hop - 1) / hop);
+    result.magnitudes.resize(static_cast<size_t>(result.numFrames) * result.numBins);
+    const size_t frames = static_cast<size_t>(result.numFrames);
+    ranges = std::max<size_t>(1, std::min(ranges, frames));
+
+    // Frames cost the same, so contiguous equal ranges balance well and
+    // keep each worker writing its own block of rows. Every range has its
+    // own FFT scratch; plan and window tables are shared read-only.
+    auto range = [&](size_t r) {
+        const size_t firstFrame = r * frames / ranges;
+        const size_t lastFrame = (r + 1) * frames / ranges;
+        FFT transform;
+        transform.setSize(fftSize);
+        std::vector<float> frame(size);
+        std::vector<std::complex<double>> bins(result.numBins);
+        const float* w = window->data();
+
+        for (size_t f = firstFrame; f < lastFrame; ++f) {
+            size_t start = f * hop;
+            size_t available = std::min(size, length - start);
+            for (size_t i = 0; i < available; ++i) {
+                frame[i] = input[start + i] * w[i];
+            }
+            std::fill(frame.begin() + available, frame.end(), 0.0f);
+
+            transform.forwardReal(frame.data(), bins.data());
+
+            float* row = result.magnitudes.data() + f * result.numBins;
+            for (int k = 0; k < result.numBins; ++k) {
+                row[k] = static_cast<float>(std::abs(bins[k]) * binScale(k));
+            }
+        }
+    };
+    pool.parallelFor(ranges, range);
+
+    return result;
+}
+
+void SpectrumAnalyzer::update(const std::vector<float>& input) {
+    update(input.data(), input.size());
+}
+
+int SpectrumAnalyzer::update(const float* input, size_t count) {
+    auto& impl = *pImpl;
+    const size_t size = impl.ring.size();
+    int produced = 0;
+
+    while (count > 0) {
+        // Copy up to the next hop boundary, splitting at the ring's end
+        size_t take = std::min(count, static_cast<size_t>(impl.hopSize - impl.samplesSinceFrame));
+        size_t first = std::min(take, size - impl.writePos);
+        std::copy(input, input + first, impl.ring.begin() + impl.writePos);
+        std::copy(input + first, input + take, impl.ring.begin());
+        impl.writePos = (impl.writePos + take) % size;
+
+        impl.samplesSinceFrame += static_cast<int>(take);
+        input += take;
+        count -= take;
+
+        if (impl.samplesSinceFrame == impl.hopSize) {
+            impl.computeRingFrame();
+            impl.samplesSinceFrame = 0;
+            ++produced;
+        }
+    }
+
+    return produced;
+}
+
+SpectrumData SpectrumAnalyzer::getCurrentSpectrum() const {
+    return pImpl->current;
+}
+
+void SpectrumAnalyzer::getCurrentSpectrum(SpectrumData& spectrum) const {
+    const auto& current = pImpl->current;
+    spectrum.frequencies.assign(current.frequencies.begin(), current.frequencies.end());
+    spectrum.magnitudes.assign(current.magnitudes.begin(), current.magnitudes.end());
+    spectrum.phases.assign(current.phases.begin(), current.phases.end());
+    spectrum.sampleRate = current.sampleRate;
+    spectrum.fftSize = current.fftSize;
+}
+
+void SpectrumAnalyzer::setFFTSize(int size) {
+    if (size < 2) {
+        throw std::invalid_argument("FFT size must be at least 2");
+    }
+    pImpl->fftSize = size;
+    pImpl->configure();
+}
+
+void SpectrumAnalyzer::setWindowType(const std::string& windowType) {
+    pImpl->windowType = MathUtils::parseWindowType(windowType);
+    pImpl->windowName = windowType;
+    pImpl->configure();
+}
+
+void SpectrumAnalyzer::setOverlap(double overlap) {
+    pImpl->overlap = MathUtils::clamp(overlap, 0.0, Impl::MAX_OVERLAP);
+    pImpl->configure();
+}
+
+void SpectrumAnalyzer::setSampleRate(double sampleRate) {
+    if (sampleRate <= 0.0) {
+        throw std::invalid_argument("Sample rate must be positive");
+    }
+    pImpl->sampleRate = sampleRate;
+    pImpl->configure();
+}
+
+void SpectrumAnalyzer::reset() {
+    std::fill(pImpl->ring.begin(), pImpl->ring.end(), 0.0f);
+    pImpl->writePos = 0;
+    pImpl->samplesSinceFrame = 0;
+    std::fill(pImpl->current.magnitudes.begin(), pImpl->current.magnitudes.end(), 0.0);
+    std::fill(pImpl->current.phases.begin(), pImpl->current.phases.end(), 0.0);
+}
+
+int SpectrumAnalyzer::getFFTSize() const {
+    return pImpl->fftSize;
+}
+
+std::string SpectrumAnalyzer::getWindowType() const {
+    return pImpl->windowName;
+}
+
+double SpectrumAnalyzer::getOverlap() const {
+    return pImpl->overlap;
+}
+
+double SpectrumAnalyzer::getSampleRate() const {
+    return pImpl->sampleRate;
+}
+
+int SpectrumAnalyzer::getHopSize() const {
+    return pImpl->hopSize;
+}
+
+std::vector<double> SpectrumAnalyzer::getFrequencyBands(const std::vector<double>& frequencies, int numBands) {
+    // frequencies is a magnitude spectrum with bins spaced evenly up to
+    // Nyquist; bins are grouped into logarithmically spaced bands and the
+    // mean magnitude of each band is returned
+    std::vector<double> bands(std::max(0, numBands), 0.0);
+    if (frequencies.size() < 2 || numBands <= 0) return bands;
+
+    const double lastBin = static_cast<double>(frequencies.size() - 1);
+    for (int b = 0; b < numBands; ++b) {
+        size_t begin = static_cast<size_t>(std::pow(lastBin, static_cast<double>(b) / numBands));
+        size_t end = static_cast<size_t>(std::pow(lastBin, static_cast<double>(b + 1) / numBands));
+        end = std::max(end, begin + 1);
+
+        double sum = 0.0;
+        for (size_t k = begin; k < end && k < frequencies.size(); ++k) {
+            sum += frequencies[k];
+        }
+        bands[b] = sum / static_cast<double>(end - begin);
+    }
+    return bands;
+}
+
+std::vector<double> SpectrumAnalyzer::getSpectralCentroid(const SpectrumData& spectrum) {
+    double weighted = 0.0;
+    double total = 0.0;
+    size_t count = std::min(spectrum.frequencies.size(), spectrum.magnitudes.size());
+    for (size_t k = 0; k < count; ++k) {
+        weighted += spectrum.frequencies[k] * spectrum.magnitudes[k];
+        total += spectrum.magnitudes[k];
+    }
+    return {total > 0.0 ? weighted / total : 0.0};
+}
+
+std::vector<double> SpectrumAnalyzer::getSpectralRolloff(const SpectrumData& spectrum, double percentile) {
+    // Frequency below which percentile of the spectral energy lies
+    size_t count = std::min(spectrum.frequencies.size(), spectrum.magnitudes.size());
+    double total = 0.0;
+    for (size_t k = 0; k < count; ++k) {
+        total += spectrum.magnitudes[k] * spectrum.magnitudes[k];
+    }
+    if (count == 0 || total <= 0.0) return {0.0};
+
+    double target = MathUtils::clamp(percentile, 0.0, 1.0) * total;
+    double cumulative = 0.0;
+    for (size_t k = 0; k < count; ++k) {
+        cumulative += spectrum.magnitudes[k] * spectrum.magnitudes[k];
+        if (cumulative >= target) {
+            return {spectrum.frequencies[k]};
+        }
+    }
+    return {spectrum.frequencies[count - 1]};
+}
+
+std::vector<int> SpectrumAnalyzer::findSpectralPeaks(const SpectrumData& spectrum, double threshold) {
+    // Local maxima above threshold relative to the largest magnitude
+    const auto& magnitudes = spectrum.magnitudes;
+    std::vector<int> peaks;
+    if (magnitudes.size() < 3) return peaks;
+
+    double maxMagnitude = *std::max_element(magnitudes.begin(), magnitudes.end());
+    double limit = threshold * maxMagnitude;
+    for (size_t k = 1; k + 1 < magnitudes.size(); ++k) {
+        if (magnitudes[k] > limit && magnitudes[k] > magnitudes[k - 1] && magnitudes[k] >= magnitudes[k + 1]) {
+            peaks.push_back(static_cast<int>(k));
+        }
+    }
+    return peaks;
+}
+
+std::vector<double> SpectrumAnalyzer::getPeakFrequencies(const SpectrumData& spectrum, const std::vector<int>& peakIndices) {
+    // Refine each peak by fitting a parabola through the log magnitudes
+    // of the peak bin and its neighbours
+    const auto& magnitudes = spectrum.magnitudes;
+    const double binWidth = spectrum.sampleRate / spectrum.fftSize;
+    std::vector<double> result;
+    result.reserve(peakIndices.size());
+
+    for (int index : peakIndices) {
+        if (index < 0 || static_cast<size_t>(index) >= magnitudes.size()) continue;
+
+        double offset = 0.0;
+        if (index > 0 && static_cast<size_t>(index) + 1 < magnitudes.size()) {
+            double left = std::log(std::max(magnitudes[index - 1], 1e-20));
+            double centre = std::log(std::max(magnitudes[index], 1e-20));
+            double right = std::log(std::max(magnitudes[index + 1], 1e-20));
+            double denominator = left - 2.0 * centre + right;
+            if (denominator < 0.0) {
+                offset = MathUtils::clamp(0.5 * (left - right) / denominator, -0.5, 0.5);
+            }
+        }
+        result.push_back((index + offset) * binWidth);
+    }
+    return result;
+}
+
+void SpectrumAnalyzer::Impl::configure() {
+    hopSize = std::max(1, static_cast<int>(std::lround(fftSize * (1.0 - overlap))));
+    fft.setSize(fftSize);
+
+    double parameter = windowType == WindowType::KAISER ? KAISER_BETA : 0.0;
+    window = &MathUtils::getWindow(windowType, fftSize, parameter);
+
+    double windowSum = 0.0;
+    for (float w : *window) windowSum += w;
+    amplitudeScale = windowSum > 0.0 ? 2.0 / windowSum : 0.0;
+
+    ring.assign(fftSize, 0.0f);
+    writePos = 0;
+    samplesSinceFrame = 0;
+    frame.assign(fftSize, 0.0f);
+    bins.assign(numBins(), std::complex<double>(0.0));
+
+    current.sampleRate = sampleRate;
+    current.fftSize = fftSize;
+    current.frequencies.resize(numBins());
+    for (int k = 0; k < numBins(); ++k) {
+        current.frequencies[k] = k * sampleRate / fftSize;
+    }
+    current.magnitudes.assign(numBins(), 0.0);
+    current.phases.assign(numBins(), 0.0);
+}
+
+void SpectrumAnalyzer::Impl::computeFrame(const float* samples, SpectrumData& target) {
+    const float* w = window->data();
+    for (int i = 0; i < fftSize; ++i) {
+        frame[i] = samples[i] * w[i];
+    }
+    transformFrame(target);
+}
+
+void SpectrumAnalyzer::Impl::computeRingFrame() {
+    // Unroll the ring oldest-first into the frame, windowing as we go
+    const float* w = window->data();
+    const size_t size = ring.size();
+    const size_t tail = size - writePos;
+    for (size_t i = 0; i < tail; ++i) {
+        frame[i] = ring[writePos + i] * w[i];
+    }
+    for (size_t i = tail; i < size; ++i) {
+        frame[i] = ring[i - tail] * w[i];
+    }
+    transformFrame(current);
+}
+
+void SpectrumAnalyzer::Impl::transformFrame(SpectrumData& target) {
+    fft.forwardReal(frame.data(), bins.data());
+
+    for (int k = 0; k < numBins(); ++k) {
+        target.magnitudes[k] = std::abs(bins[k]) * binScale(k);
+        target.phases[k] = std::arg(bins[k]);
+    }
+}
+
+} // namespace signal
+} // namespace song_processor
@@ -1,108 +1,343 @@
 #include "utils/audio_utils.hpp"
+#include "audio/sample_conversion.hpp"
+#include "simd.hpp"
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <numeric>
+#include <stdexcept>
 
 namespace song_processor {
 namespace utils {
 
+namespace {
+
+// int16 samples are widened through a stack block of this many values
+constexpr size_t CONVERSION_BLOCK = 256;
+
+// Strides accumulated in float lanes before folding into double totals,
+// which keeps both the float sums exact enough and the loop vectorised
+constexpr size_t STATS_BLOCK_STRIDES = 1024;
+
+struct StatisticsLanes {
+    Float4 sum;
+    Float4 squares;
+    Float4 finite;
+    Float4 clips;
+    Float4 peak;
+    Float4 min;
+    Float4 max;
+};
+
+// Statistics over whole strides of 4 * channels samples. Within a stride
+// lane j of vector v always holds channel (4v + j) % channels, so one set
+// of lane accumulators per vector covers every channel of interleaved data.
+// FixedChannels, when non-zero, lets the compiler keep them in registers.
+template <size_t FixedChannels>
+void accumulateStrides(const float* input, size_t strides, size_t runtimeChannels, std::vector<ChannelStatistics>& out) {
+    const size_t channels = FixedChannels != 0 ? FixedChannels : runtimeChannels;
+    const size_t stride = channels * Float4::WIDTH;
+    const Float4 zero = Float4::zero();
+    const Float4 one = Float4::broadcast(1.0f);
+    const Float4 inf = Float4::broadcast(std::numeric_limits<float>::infinity());
+    const Float4 negInf = Float4::broadcast(-std::numeric_limits<float>::infinity());
+
+    std::vector<StatisticsLanes> lanes(channels, {zero, zero, zero, zero, zero, inf, negInf});
+    std::vector<double> sums(stride, 0.0);
+    std::vector<double> squares(stride, 0.0);
+    std::vector<size_t> finites(stride, 0);
+    std::vector<size_t> clips(stride, 0);
+
+    alignas(16) float lane[Float4::WIDTH];
+    auto fold = [&](size_t v) {
+        StatisticsLanes& acc = lanes[v];
+        acc.sum.store(lane);
+        for (int j = 0; j < Float4::WIDTH; ++j) sums[v * Float4::WIDTH + j] += lane[j];
+        acc.squares.store(lane);
+        for (int j = 0; j < Float4::WIDTH; ++j) squares[v * Float4::WIDTH + j] += lane[j];
+        acc.finite.store(lane);
+        for (int j = 0; j < Float4::WIDTH; ++j) finites[v * Float4::WIDTH + j] += static_cast<size_t>(lane[j]);
+        acc.clips.store(lane);
+        for (int j = 0; j < Float4::WIDTH; ++j) clips[v * Float4::WIDTH + j] += static_cast<size_t>(lane[j]);
+        acc.sum = acc.squares = acc.finite = acc.clips = zero;
+    };
+
+    while (strides > 0) {
+        size_t count = std::min(strides, STATS_BLOCK_STRIDES);
+        for (size_t s = 0; s < count; ++s) {
+            for (size_t v = 0; v < channels; ++v) {
+                StatisticsLanes& acc = lanes[v];
+                Float4 x = Float4::loadU(input + v * Float4::WIDTH);
+
+                // x - x is zero exactly when x is finite
+                Float4 finite = (x - x) == zero;
+                Float4 value = x & finite;
+                Float4 magnitude = abs(value);
+
+                acc.sum += value;
+                acc.squares += value * value;
+                acc.finite += finite & one;
+                acc.clips += (magnitude > one) & one;
+                acc.peak = max(acc.peak, magnitude);
+                acc.min = min(acc.min, select(finite, x, inf));
+                acc.max = max(acc.max, select(finite, x, negInf));
+            }
+            input += stride;
+        }
+        for (size_t v = 0; v < channels; ++v) fold(v);
+        strides -= count;
+    }
+
+    // Reduce lanes to their channels
+    alignas(16) float peaks[Float4::WIDTH];
+    alignas(16) float mins[Float4::WIDTH];
+    alignas(16) float maxs[Float4::WIDTH];
+    for (size_t v = 0; v < channels; ++v) {
+        lanes[v].peak.store(peaks);
+        lanes[v].min.store(mins);
+        lanes[v].max.store(maxs);
+        for (int j = 0; j < Float4::WIDTH; ++j) {
+            size_t index = v * Float4::WIDTH + j;
+            ChannelStatistics& stats = out[index % channels];
+            stats.sum += sums[index];
+            stats.sumOfSquares += squares[index];
+            stats.nonFiniteCount -= finites[index]; // completed by the caller
+            stats.clipCount += clips[index];
+            stats.peak = std::max(stats.peak, peaks[j]);
+            stats.min = std::min(stats.min, mins[j]);
+            stats.max = std::max(stats.max, maxs[j]);
+        }
+    }
+}
+
+// Largest finite |x|, four lanes at a time
+float measurePeak(const float* input, size_t samples) {
+    const Float4 zero = Float4::zero();
+    Float4 peak = zero;
+    size_t i = 0;
+    for (; i + Float4::WIDTH <= samples; i += Float4::WIDTH) {
+        Float4 x = Float4::loadU(input + i);
+        peak = max(peak, abs(x & ((x - x) == zero)));
+    }
+
+    alignas(16) float lanes[Float4::WIDTH];
+    peak.store(lanes);
+    float result = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    for (; i < samples; ++i) {
+        if (std::isfinite(input[i])) result = std::max(result, std::abs(input[i]));
+    }
+    return result;
+}
+
+size_t durationToFrames(double durationMs, int sampleRate) {
+    return durationMs > 0.0 ? static_cast<size_t>(durationMs * sampleRate / 1000.0) : 0;
+}
+
+} // namespace
+
+GainEnvelope& GainEnvelope::fadeIn(double durationMs) {
+    fadeInMs = std::max(0.0, durationMs);
+    return *this;
+}
+
+GainEnvelope& GainEnvelope::fadeOut(double durationMs) {
+    fadeOutMs = std::max(0.0, durationMs);
+    return *this;
+}
+
+GainEnvelope& GainEnvelope::normalize(float targetLevel) {
+    normalizeTarget = std::max(0.0f, targetLevel);
+    return *this;
+}
+
+GainEnvelope& GainEnvelope::preventClipping(float threshold) {
+    clipThreshold = std::max(0.0f, threshold);
+    return *this;
+}
+
+GainEnvelope& GainEnvelope::setSourcePeak(float peak) {
+    sourcePeak = std::max(0.0f, peak);
+    return *this;
+}
+
+void GainEnvelope::apply(const float* input, float* output, size_t frames, int channels, int sampleRate) const {
+    const size_t numChannels = static_cast<size_t>(std::max(1, channels));
+
+    // Level stages reduce to one constant gain
+    float gain = 1.0f;
+    if (normalizeTarget >= 0.0f || clipThreshold >= 0.0f) {
+        float peak = sourcePeak >= 0.0f ? sourcePeak : measurePeak(input, frames * numChannels);
+        if (peak > 0.0f) {
+            if (normalizeTarget >= 0.0f) gain = normalizeTarget / peak;
+            if (clipThreshold >= 0.0f) gain = std::min(gain, clipThreshold / peak);
+        }
+    }
+
+    // Linear ramps from silence at the first frame and to silence at the last
+    const size_t fadeInLength = durationToFrames(fadeInMs, sampleRate);
+    const size_t fadeOutLength = durationToFrames(fadeOutMs, sampleRate);
+    const size_t fadeInEnd = std::min(frames, fadeInLength);
+    const size_t fadeOutStart = frames - std::min(frames, fadeOutLength);
+
+    auto scaleFrame = [&](size_t frame, float frameGain) {
+        for (size_t ch = 0; ch < numChannels; ++ch) {
+            output[frame * numChannels + ch] = input[frame * numChannels + ch] * frameGain;
+        }
+    };
+    auto fadeOutGain = [&](size_t frame) {
+        return frame >= fadeOutStart ? static_cast<float>(frames - 1 - frame) / fadeOutLength : 1.0f;
+    };
+
+    for (size_t f = 0; f < fadeInEnd; ++f) {
+        scaleFrame(f, gain * (static_cast<float>(f) / fadeInLength) * fadeOutGain(f));
+    }
+
+    const size_t bodyEnd = std::max(fadeOutStart, fadeInEnd);
+    for (size_t i = fadeInEnd * numChannels; i < bodyEnd * numChannels; ++i) {
+        output[i] = input[i] * gain;
+    }
+
+    for (size_t f = bodyEnd; f < frames; ++f) {
+        scaleFrame(f, gain * fadeOutGain(f));
+    }
+}
+
+void GainEnvelope::apply(std::vector<float>& samples, int channels, int sampleRate) const {
+    apply(samples.data(), samples.data(), samples.size() / std::max(1, channels), channels, sampleRate);
+}
+
+double ChannelStatistics::rms() const {
+    size_t finite = sampleCount - nonFiniteCount;
+    return finite > 0 ? std::sqrt(sumOfSquares / finite) : 0.0;
+}
+
+double ChannelStatistics::dcOffset() const {
+    size_t finite = sampleCount - nonFiniteCount;
+    return finite > 0 ? sum / finite : 0.0;
+}
+
+double ChannelStatistics::dynamicRange() const {
+    return peak > 0.0f ? 20.0 * std::log10(peak / rms()) : 0.0;
+}
+
+bool ChannelStatistics::isValid() const {
+    return sampleCount > 0 && nonFiniteCount == 0;
+}
+
+bool ChannelStatistics::isClipping() const {
+    return clipCount > 0;
+}
+
+ChannelStatistics AudioStatistics::combined() const {
+    ChannelStatistics total;
+    bool anyFinite = false;
+    for (const auto& channel : channels) {
+        total.sampleCount += channel.sampleCount;
+        total.nonFiniteCount += channel.nonFiniteCount;
+        total.clipCount += channel.clipCount;
+        total.sum += channel.sum;
+        total.sumOfSquares += channel.sumOfSquares;
+        total.peak = std::max(total.peak, channel.peak);
+        if (channel.sampleCount > channel.nonFiniteCount) {
+            total.min = anyFinite ? std::min(total.min, channel.min) : channel.min;
+            total.max = anyFinite ? std::max(total.max, channel.max) : channel.max;
+            anyFinite = true;
+        }
+    }
+    return total;
+}
+
 std::vector<float> AudioUtils::convertToFloat(const std::vector<int16_t>& input) {
     std::vector<float> output(input.size());
-    for (size_t i = 0; i < input.size(); ++i) {
-        output[i] = static_cast<float>(input[i]) / 32768.0f;
+    int32_t block[CONVERSION_BLOCK];
+    for (size_t start = 0; start < input.size(); start += CONVERSION_BLOCK) {
+        const size_t n = std::min(CONVERSION_BLOCK, input.size() - start);
+        std::copy(input.begin() + start, input.begin() + start + n, block);
+        audio::decodeSamples(block, 16, output.data() + start, n);
     }
     return output;
 }
 
 std::vector<float> AudioUtils::convertToFloat(const std::vector<int32_t>& input) {
     std::vector<float> output(input.size());
-    for (size_t i = 0; i < input.size(); ++i) {
-        output[i] = static_cast<float>(input[i]) / 2147483648.0f;
-    }
+    audio::decodeSamples(input.data(), 32, output.data(), input.size());
     return output;
 }
 
 std::vector<int16_t> AudioUtils::convertToInt16(const std::vector<float>& input) {
     std::vector<int16_t> output(input.size());
-    for (size_t i = 0; i < input.size(); ++i) {
-        float clamped = std::max(-1.0f, std::min(1.0f, input[i]));
-        output[i] = static_cast<int16_t>(clamped * 32767.0f);
+    int32_t block[CONVERSION_BLOCK];
+    for (size_t start = 0; start < input.size(); start += CONVERSION_BLOCK) {
+        const size_t n = std::min(CONVERSION_BLOCK, input.size() - start);
+        audio::encodeSamples(input.data() + start, 16, block, n);
+        std::copy(block, block + n, output.begin() + start);
     }
     return output;
 }
 
 std::vector<int32_t> AudioUtils::convertToInt32(const std::vector<float>& input) {
     std::vector<int32_t> output(input.size());
-    for (size_t i = 0; i < input.size(); ++i) {
-        float clamped = std::max(-1.0f, std::min(1.0f, input[i]));
-        output[i] = static_cast<int32_t>(clamped * 2147483647.0f);
-    }
+    audio::encodeSamples(input.data(), 32, output.data(), input.size());
     return output;
 }
 
 std::vector<float> AudioUtils::normalize(const std::vector<float>& input, float targetLevel) {
-    if (input.empty()) return input;
-    
-    double peak = calculatePeak(input);
-    if (peak <= 0.0) return input;
-    
-    float scale = targetLevel / static_cast<float>(peak);
     std::vector<float> output(input.size());
-    
-    for (size_t i = 0; i < input.size(); ++i) {
-        output[i] = input[i] * scale;
-    }
-    
+    normalize(input.data(), output.data(), input.size(), targetLevel);
     return output;
 }
 
-std::vector<float> AudioUtils::fadeIn(const std::vector<float>& input, double durationMs) {
-    std::vector<float> output = input;
-    int fadeSamples = msToSamples(static_cast<int>(durationMs), 44100); // Assuming 44.1kHz
-    
-    for (int i = 0; i < std::min(fadeSamples, static_cast<int>(input.size())); ++i) {
-        float fade = static_cast<float>(i) / fadeSamples;
-        output[i] *= fade;
-    }
-    
+std::vector<float> AudioUtils::fadeIn(const std::vector<float>& input, double durationMs, int sampleRate, int channels) {
+    std::vector<float> output(input.size());
+    channels = std::max(1, channels);
+    fadeIn(input.data(), output.data(), input.size() / channels, channels, durationMs, sampleRate);
     return output;
 }
 
-std::vector<float> AudioUtils::fadeOut(const std::vector<float>& input, double durationMs) {
-    std::vector<float> output = input;
-    int fadeSamples = msToSamples(static_cast<int>(durationMs), 44100); // Assuming 44.1kHz
-    
-    for (int i = 0; i < std::min(fadeSamples, static_cast<int>(input.size())); ++i) {
-        float fade = static_cast<float>(fadeSamples - i) / fadeSamples;
-        output[output.size() - 1 - i] *= fade;
-    }
-    
+std::vector<float> AudioUtils::fadeOut(const std::vector<float>& input, double durationMs, int sampleRate, int channels) {
+    std::vector<float> output(input.size());
+    channels = std::max(1, channels);
+    fadeOut(input.data(), output.data(), input.size() / channels, channels, durationMs, sampleRate);
     return output;
 }
 
+void AudioUtils::normalize(const float* input, float* output, size_t samples, float targetLevel) {
+    GainEnvelope().normalize(targetLevel).apply(input, output, samples, 1, 1);
+}
+
+void AudioUtils::fadeIn(const float* input, float* output, size_t frames, int channels, double durationMs, int sampleRate) {
+    GainEnvelope().fadeIn(durationMs).apply(input, output, frames, channels, sampleRate);
+}
+
+void AudioUtils::fadeOut(const float* input, float* output, size_t frames, int channels, double durationMs, int sampleRate) {
+    GainEnvelope().fadeOut(durationMs).apply(input, output, frames, channels, sampleRate);
+}
+
 std::pair<std::vector<float>, std::vector<float>> AudioUtils::splitStereo(const std::vector<float>& stereo) {
-    std::vector<float> left, right;
-    left.reserve(stereo.size() / 2);
-    right.reserve(stereo.size() / 2);
+    // An odd trailing sample belongs to the left channel only
+    std::vector<float> left((stereo.size() + 1) / 2);
+    std::vector<float> right(stereo.size() / 2);
     
-    for (size_t i = 0; i < stereo.size(); i += 2) {
-        left.push_back(stereo[i]);
-        if (i + 1 < stereo.size()) {
-            right.push_back(stereo[i + 1]);
-        }
+    for (size_t i = 0; i < right.size(); ++i) {
+        left[i] = stereo[i * 2];
+        right[i] = stereo[i * 2 + 1];
+    }
+    if (left.size() > right.size()) {
+        left.back() = stereo.back();
     }
     
-    return {left, right};
+    return {std::move(left), std::move(right)};
 }
 
 std::vector<float> AudioUtils::mergeStereo(const std::vector<float>& left, const std::vector<float>& right) {
-    std::vector<float> stereo;
-    stereo.reserve(left.size() + right.size());
+    const size_t frames = std::max(left.size(), right.size());
+    std::vector<float> stereo(frames * 2, 0.0f);
     
-    size_t maxSize = std::max(left.size(), right.size());
-    for (size_t i = 0; i < maxSize; ++i) {
-        stereo.push_back(i < left.size() ? left[i] : 0.0f);
-        stereo.push_back(i < right.size() ? right[i] : 0.0f);
+    for (size_t i = 0; i < left.size(); ++i) {
+        stereo[i * 2] = left[i];
+    }
+    for (size_t i = 0; i < right.size(); ++i) {
+        stereo[i * 2 + 1] = right[i];
     }
     
     return stereo;
@@ -158,10 +393,8 @@ double AudioUtils::calculatePeak(const std::vector<float>& input) {
 double AudioUtils::calculateDynamicRange(const std::vector<float>& input) {
     if (input.empty()) return 0.0;
     
-    double peak = calculatePeak(input);
-    double rms = calculateRMS(input);
-    
-    return (peak > 0.0) ? 20.0 * log10(peak / rms) : 0.0;
+    // Peak and RMS from the same pass
+    return calculateStatistics(input).channels[0].dynamicRange();
 }
 
 std::vector<double> AudioUtils::calculateSpectrum(const std::vector<float>& input, int fftSize) {
@@ -174,6 +407,57 @@ std::vector<double> AudioUtils::calculateSpectrum(const std::vector<float>& inpu
     return spectrum;
 }
 
+AudioStatistics AudioUtils::calculateStatistics(const float* input, size_t frames, int channels) {
+    if (channels < 1) {
+        throw std::invalid_argument("Channel count must be at least 1");
+    }
+
+    const size_t numChannels = static_cast<size_t>(channels);
+    AudioStatistics stats;
+    stats.channels.resize(numChannels);
+    for (auto& channel : stats.channels) {
+        channel.sampleCount = frames;
+        channel.nonFiniteCount = frames; // finite samples are subtracted below
+        channel.min = std::numeric_limits<float>::infinity();
+        channel.max = -std::numeric_limits<float>::infinity();
+    }
+
+    const size_t total = frames * numChannels;
+    const size_t stride = numChannels * Float4::WIDTH;
+    const size_t strides = total / stride;
+    switch (numChannels) {
+        case 1: accumulateStrides<1>(input, strides, numChannels, stats.channels); break;
+        case 2: accumulateStrides<2>(input, strides, numChannels, stats.channels); break;
+        default: accumulateStrides<0>(input, strides, numChannels, stats.channels); break;
+    }
+
+    // Tail that does not fill a whole stride
+    for (size_t i = strides * stride; i < total; ++i) {
+        ChannelStatistics& channel = stats.channels[i % numChannels];
+        float x = input[i];
+        if (!std::isfinite(x)) continue;
+        float magnitude = std::abs(x);
+        --channel.nonFiniteCount;
+        channel.sum += x;
+        channel.sumOfSquares += static_cast<double>(x) * x;
+        channel.clipCount += magnitude > 1.0f ? 1 : 0;
+        channel.peak = std::max(channel.peak, magnitude);
+        channel.min = std::min(channel.min, x);
+        channel.max = std::max(channel.max, x);
+    }
+
+    for (auto& channel : stats.channels) {
+        if (channel.nonFiniteCount == channel.sampleCount) {
+            channel.min = channel.max = 0.0f;
+        }
+    }
+    return stats;
+}
+
+AudioStatistics AudioUtils::calculateStatistics(const std::vector<float>& input, int channels) {
+    return calculateStatistics(input.data(), input.size() / std::max(1, channels), channels);
+}
+
 int AudioUtils::samplesToMs(int samples, int sampleRate) {
     return static_cast<int>((static_cast<double>(samples) / sampleRate) * 1000.0);
 }
@@ -212,22 +496,14 @@ bool AudioUtils::isClipping(const std::vector<float>& input) {
 }
 
 std::vector<float> AudioUtils::preventClipping(const std::vector<float>& input, float threshold) {
-    std::vector<float> output = input;
-    float maxSample = 0.0f;
-    
-    for (float sample : input) {
-        maxSample = std::max(maxSample, std::abs(sample));
-    }
-    
-    if (maxSample > threshold) {
-        float scale = threshold / maxSample;
-        for (float& sample : output) {
-            sample *= scale;
-        }
-    }
-    
+    std::vector<float> output(input.size());
+    preventClipping(input.data(), output.data(), input.size(), threshold);
     return output;
 }
 
+void AudioUtils::preventClipping(const float* input, float* output, size_t samples, float threshold) {
+    GainEnvelope().preventClipping(threshold).apply(input, output, samples, 1, 1);
+}
+
 } // namespace utils
 } // namespace song_processor 
\ No newline at end of file
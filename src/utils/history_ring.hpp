@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace song_processor {
+namespace utils {
+
+// Fixed-capacity ring of the most recent values written by one producer
+// thread, readable from any number of other threads without locking.
+//
+// The producer stores the value into its slot and then publishes it by
+// advancing a monotonic write counter with release ordering. Readers load
+// the counter with acquire ordering and copy the slots behind it. A reader
+// racing a producer that laps it may see a newer value in an old slot,
+// which is acceptable for metering; it never sees a torn value because
+// every slot is itself atomic. Memory use is fixed at Capacity values.
+template <typename T, size_t Capacity>
+class HistoryRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "HistoryRing capacity must be a power of two");
+
+public:
+    HistoryRing() { clear(); }
+
+    HistoryRing(const HistoryRing&) = delete;
+    HistoryRing& operator=(const HistoryRing&) = delete;
+
+    // Producer only
+    void push(T value) {
+        uint64_t count = written.load(std::memory_order_relaxed);
+        slots[count & (Capacity - 1)].store(value, std::memory_order_relaxed);
+        written.store(count + 1, std::memory_order_release);
+    }
+
+    // Producer only
+    void clear() {
+        for (auto& slot : slots) {
+            slot.store(T(), std::memory_order_relaxed);
+        }
+        written.store(0, std::memory_order_release);
+    }
+
+    size_t size() const {
+        uint64_t count = written.load(std::memory_order_acquire);
+        return count < Capacity ? static_cast<size_t>(count) : Capacity;
+    }
+
+    // Most recent value, or T() when empty
+    T latest() const {
+        uint64_t count = written.load(std::memory_order_acquire);
+        return count == 0 ? T() : slots[(count - 1) & (Capacity - 1)].load(std::memory_order_relaxed);
+    }
+
+    // Retained values, oldest first
+    std::vector<T> snapshot() const {
+        uint64_t count = written.load(std::memory_order_acquire);
+        size_t n = count < Capacity ? static_cast<size_t>(count) : Capacity;
+        std::vector<T> result(n);
+        for (size_t i = 0; i < n; ++i) {
+            result[i] = slots[(count - n + i) & (Capacity - 1)].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+private:
+    std::array<std::atomic<T>, Capacity> slots;
+    std::atomic<uint64_t> written{0};
+};
+
+} // namespace utils
+} // namespace song_processor
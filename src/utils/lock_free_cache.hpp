@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+namespace song_processor {
+namespace utils {
+
+// Insert-only hash map of immutable values shared across threads.
+//
+// Lookups are wait-free: they walk a bucket's singly linked list through
+// acquire loads and never block. Inserts publish a fully built node with a
+// compare-and-swap on the bucket head. Two threads missing on the same key
+// may both build a value; the loser discards its copy and returns the
+// winner's, so callers always observe a single instance per key.
+// Entries are never removed, which is what makes the returned references
+// stable for the lifetime of the cache.
+template <typename Key, typename Value, typename Hash = std::hash<Key>, size_t Buckets = 256>
+class LockFreeCache {
+public:
+    LockFreeCache() {
+        for (auto& bucket : buckets) {
+            bucket.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~LockFreeCache() {
+        for (auto& bucket : buckets) {
+            Node* node = bucket.load(std::memory_order_relaxed);
+            while (node != nullptr) {
+                Node* next = node->next;
+                delete node;
+                node = next;
+            }
+        }
+    }
+
+    LockFreeCache(const LockFreeCache&) = delete;
+    LockFreeCache& operator=(const LockFreeCache&) = delete;
+
+    // Return the value for key, building it with make() on first use
+    template <typename Factory>
+    const Value& getOrCreate(const Key& key, Factory&& make) {
+        std::atomic<Node*>& bucket = buckets[Hash()(key) % Buckets];
+        Node* head = bucket.load(std::memory_order_acquire);
+        if (const Node* found = find(head, nullptr, key)) {
+            return found->value;
+        }
+
+        Node* node = new Node{key, make(), head};
+        while (!bucket.compare_exchange_weak(node->next, node,
+                                             std::memory_order_release,
+                                             std::memory_order_acquire)) {
+            // Someone else inserted first; only the new prefix needs checking
+            if (const Node* found = find(node->next, head, key)) {
+                delete node;
+                return found->value;
+            }
+            head = node->next;
+        }
+        return node->value;
+    }
+
+private:
+    struct Node {
+        Key key;
+        Value value;
+        Node* next;
+    };
+
+    static const Node* find(const Node* node, const Node* stop, const Key& key) {
+        for (; node != stop; node = node->next) {
+            if (node->key == key) return node;
+        }
+        return nullptr;
+    }
+
+    std::array<std::atomic<Node*>, Buckets> buckets;
+};
+
+} // namespace utils
+} // namespace song_processor
@@ -1,14 +1,45 @@
 #include "utils/math_utils.hpp"
+#include "utils/filter_design.hpp"
+#include "lock_free_cache.hpp"
 #include <algorithm>
 #include <cmath>
 #include <random>
 #include <numeric>
+#include <stdexcept>
 
 namespace song_processor {
 namespace utils {
 
 // Mathematical constants are defined in the header
 
+namespace {
+
+struct WindowKey {
+    WindowType type;
+    int size;
+    double parameter;
+    
+    bool operator==(const WindowKey& other) const {
+        return type == other.type && size == other.size && parameter == other.parameter;
+    }
+};
+
+struct WindowKeyHash {
+    size_t operator()(const WindowKey& key) const {
+        size_t h = std::hash<int>()(static_cast<int>(key.type));
+        h = h * 31 + std::hash<int>()(key.size);
+        h = h * 31 + std::hash<double>()(key.parameter);
+        return h;
+    }
+};
+
+std::vector<float> copyWindow(WindowType type, int size, double parameter = 0.0) {
+    const auto window = MathUtils::buildWindow(type, size, parameter);
+    return std::vector<float>(window.begin(), window.end());
+}
+
+} // namespace
+
 double MathUtils::clamp(double value, double min, double max) {
     return std::max(min, std::min(max, value));
 }
@@ -56,40 +87,80 @@ double MathUtils::midiToFrequency(double midiNote) {
 }
 
 std::vector<float> MathUtils::hanningWindow(int size) {
-    std::vector<float> window(size);
-    for (int i = 0; i < size; ++i) {
-        window[i] = 0.5f * (1.0f - std::cos(2.0f * PI * i / (size - 1)));
-    }
-    return window;
+    return copyWindow(WindowType::HANNING, size);
 }
 
 std::vector<float> MathUtils::hammingWindow(int size) {
-    std::vector<float> window(size);
-    for (int i = 0; i < size; ++i) {
-        window[i] = 0.54f - 0.46f * std::cos(2.0f * PI * i / (size - 1));
-    }
-    return window;
+    return copyWindow(WindowType::HAMMING, size);
 }
 
 std::vector<float> MathUtils::blackmanWindow(int size) {
-    std::vector<float> window(size);
-    for (int i = 0; i < size; ++i) {
-        window[i] = 0.42f - 0.5f * std::cos(2.0f * PI * i / (size - 1)) + 0.08f * std::cos(4.0f * PI * i / (size - 1));
-    }
-    return window;
+    return copyWindow(WindowType::BLACKMAN, size);
 }
 
 std::vector<float> MathUtils::kaiserWindow(int size, double beta) {
-    std::vector<float> window(size);
-    double i0_beta = std::cyl_bessel_i(0, beta);
+    return copyWindow(WindowType::KAISER, size, beta);
+}
+
+AlignedVector<float> MathUtils::buildWindow(WindowType type, int size, double parameter) {
+    size = std::max(0, size);
+    AlignedVector<float> window(size, 1.0f);
+    const double denominator = size > 1 ? size - 1 : 1;
     
-    for (int i = 0; i < size; ++i) {
-        double x = 2.0 * i / (size - 1) - 1.0;
-        window[i] = static_cast<float>(std::cyl_bessel_i(0, beta * std::sqrt(1.0 - x * x)) / i0_beta);
+    switch (type) {
+        case WindowType::RECTANGULAR:
+            break;
+        case WindowType::HANNING:
+            for (int i = 0; i < size; ++i) {
+                window[i] = static_cast<float>(0.5 * (1.0 - std::cos(MathUtils::TWO_PI * i / denominator)));
+            }
+            break;
+        case WindowType::HAMMING:
+            for (int i = 0; i < size; ++i) {
+                window[i] = static_cast<float>(0.54 - 0.46 * std::cos(MathUtils::TWO_PI * i / denominator));
+            }
+            break;
+        case WindowType::BLACKMAN:
+            for (int i = 0; i < size; ++i) {
+                window[i] = static_cast<float>(0.42 - 0.5 * std::cos(MathUtils::TWO_PI * i / denominator) +
+                                               0.08 * std::cos(2.0 * MathUtils::TWO_PI * i / denominator));
+            }
+            break;
+        case WindowType::KAISER: {
+            double i0Beta = std::cyl_bessel_i(0, parameter);
+            for (int i = 0; i < size; ++i) {
+                double x = 2.0 * i / denominator - 1.0;
+                window[i] = static_cast<float>(std::cyl_bessel_i(0, parameter * std::sqrt(std::max(0.0, 1.0 - x * x))) / i0Beta);
+            }
+            break;
+        }
     }
+    
     return window;
 }
 
+const AlignedVector<float>& MathUtils::getWindow(WindowType type, int size, double parameter) {
+    // Intentionally never destroyed, so tables outlive any static user
+    static auto* cache = new LockFreeCache<WindowKey, AlignedVector<float>, WindowKeyHash>();
+    
+    size = std::max(0, size);
+    if (type != WindowType::KAISER) {
+        parameter = 0.0; // Only Kaiser is parameterised
+    }
+    
+    WindowKey key{type, size, parameter};
+    return cache->getOrCreate(key, [&] { return buildWindow(type, size, parameter); });
+}
+
+WindowType MathUtils::parseWindowType(const std::string& name) {
+    if (name == "hanning") return WindowType::HANNING;
+    if (name == "hamming") return WindowType::HAMMING;
+    if (name == "blackman") return WindowType::BLACKMAN;
+    if (name == "kaiser") return WindowType::KAISER;
+    if (name == "rectangular") return WindowType::RECTANGULAR;
+    throw std::invalid_argument("Unknown window type: " + name);
+}
+
 double MathUtils::mean(const std::vector<double>& data) {
     if (data.empty()) return 0.0;
     return std::accumulate(data.begin(), data.end(), 0.0) / data.size();
@@ -152,22 +223,24 @@ std::vector<double> MathUtils::phase(const std::vector<std::complex<double>>& co
     return result;
 }
 
+namespace {
+
+std::vector<double> toVector(const filter_design::SosDesign& design) {
+    return std::vector<double>(design.coefficients.begin(), design.coefficients.begin() + design.size());
+}
+
+} // namespace
+
 std::vector<double> MathUtils::butterworthCoefficients(int order, double cutoff, double sampleRate) {
-    // Placeholder implementation
-    std::vector<double> coeffs(order + 1, 1.0);
-    return coeffs;
+    return toVector(filter_design::butterworth(order, cutoff, sampleRate));
 }
 
 std::vector<double> MathUtils::chebyshevCoefficients(int order, double cutoff, double sampleRate, double ripple) {
-    // Placeholder implementation
-    std::vector<double> coeffs(order + 1, 1.0);
-    return coeffs;
+    return toVector(filter_design::chebyshev(order, cutoff, sampleRate, ripple));
 }
 
 std::vector<double> MathUtils::ellipticCoefficients(int order, double cutoff, double sampleRate, double ripple, double stopband) {
-    // Placeholder implementation
-    std::vector<double> coeffs(order + 1, 1.0);
-    return coeffs;
+    return toVector(filter_design::elliptic(order, cutoff, sampleRate, ripple, stopband));
 }
 
 bool MathUtils::isPowerOfTwo(int n) {
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SONG_PROCESSOR_SIMD_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SONG_PROCESSOR_SIMD_NEON 1
+#include <arm_neon.h>
+#else
+#include <cmath>
+#include <cstring>
+#endif
+
+namespace song_processor {
+namespace utils {
+
+// Four packed floats. Maps onto SSE2 on x86, NEON on ARM and plain arrays
+// elsewhere, so kernels are written once against this type. load/store
+// expect 16-byte aligned pointers; the U variants accept any address.
+// Comparisons return lane masks (all bits set where true) for use with
+// select() and operator&. Integer conversions round to nearest and expect
+// values already inside the int32 range.
+struct Float4 {
+    static constexpr int WIDTH = 4;
+
+#if defined(SONG_PROCESSOR_SIMD_SSE)
+    __m128 v;
+
+    Float4() = default;
+    Float4(__m128 value) : v(value) {}
+
+    static Float4 zero() { return _mm_setzero_ps(); }
+    static Float4 broadcast(float x) { return _mm_set1_ps(x); }
+    static Float4 set(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+    static Float4 load(const float* p) { return _mm_load_ps(p); }
+    static Float4 loadU(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_store_ps(p, v); }
+    void storeU(float* p) const { _mm_storeu_ps(p, v); }
+    static Float4 loadInt32(const int32_t* p) {
+        return _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    }
+    void storeInt32(int32_t* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_cvtps_epi32(v)); }
+
+    friend Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+    friend Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+    friend Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+    friend Float4 min(Float4 a, Float4 b) { return _mm_min_ps(a.v, b.v); }
+    friend Float4 max(Float4 a, Float4 b) { return _mm_max_ps(a.v, b.v); }
+    friend Float4 abs(Float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+
+    friend Float4 operator>(Float4 a, Float4 b) { return _mm_cmpgt_ps(a.v, b.v); }
+    friend Float4 operator==(Float4 a, Float4 b) { return _mm_cmpeq_ps(a.v, b.v); }
+    friend Float4 operator&(Float4 a, Float4 b) { return _mm_and_ps(a.v, b.v); }
+    friend Float4 select(Float4 mask, Float4 a, Float4 b) {
+        return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+    }
+
+    float sum() const {
+        __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 pairs = _mm_add_ps(v, shuffled);
+        shuffled = _mm_movehl_ps(shuffled, pairs);
+        return _mm_cvtss_f32(_mm_add_ss(pairs, shuffled));
+    }
+#elif defined(SONG_PROCESSOR_SIMD_NEON)
+    float32x4_t v;
+
+    Float4() = default;
+    Float4(float32x4_t value) : v(value) {}
+
+    static Float4 zero() { return vdupq_n_f32(0.0f); }
+    static Float4 broadcast(float x) { return vdupq_n_f32(x); }
+    static Float4 set(float a, float b, float c, float d) {
+        const float lanes[4] = {a, b, c, d};
+        return vld1q_f32(lanes);
+    }
+    static Float4 load(const float* p) { return vld1q_f32(p); }
+    static Float4 loadU(const float* p) { return vld1q_f32(p); }
+    void store(float* p) const { vst1q_f32(p, v); }
+    void storeU(float* p) const { vst1q_f32(p, v); }
+    static Float4 loadInt32(const int32_t* p) { return vcvtq_f32_s32(vld1q_s32(p)); }
+    void storeInt32(int32_t* p) const {
+#if defined(__aarch64__)
+        vst1q_s32(p, vcvtnq_s32_f32(v));
+#else
+        // ARMv7 only truncates; offset by half away from zero first
+        uint32x4_t negative = vcltq_f32(v, vdupq_n_f32(0.0f));
+        float32x4_t half = vbslq_f32(negative, vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f));
+        vst1q_s32(p, vcvtq_s32_f32(vaddq_f32(v, half)));
+#endif
+    }
+
+    friend Float4 operator+(Float4 a, Float4 b) { return vaddq_f32(a.v, b.v); }
+    friend Float4 operator-(Float4 a, Float4 b) { return vsubq_f32(a.v, b.v); }
+    friend Float4 operator*(Float4 a, Float4 b) { return vmulq_f32(a.v, b.v); }
+    friend Float4 min(Float4 a, Float4 b) { return vminq_f32(a.v, b.v); }
+    friend Float4 max(Float4 a, Float4 b) { return vmaxq_f32(a.v, b.v); }
+    friend Float4 abs(Float4 a) { return vabsq_f32(a.v); }
+
+    friend Float4 operator>(Float4 a, Float4 b) { return vreinterpretq_f32_u32(vcgtq_f32(a.v, b.v)); }
+    friend Float4 operator==(Float4 a, Float4 b) { return vreinterpretq_f32_u32(vceqq_f32(a.v, b.v)); }
+    friend Float4 operator&(Float4 a, Float4 b) {
+        return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v)));
+    }
+    friend Float4 select(Float4 mask, Float4 a, Float4 b) {
+        return vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v);
+    }
+
+    float sum() const {
+        float32x2_t pairs = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+        return vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+    }
+#else
+    float v[4];
+
+    static Float4 zero() { return set(0.0f, 0.0f, 0.0f, 0.0f); }
+    static Float4 broadcast(float x) { return set(x, x, x, x); }
+    static Float4 set(float a, float b, float c, float d) {
+        Float4 r;
+        r.v[0] = a; r.v[1] = b; r.v[2] = c; r.v[3] = d;
+        return r;
+    }
+    static Float4 load(const float* p) { return set(p[0], p[1], p[2], p[3]); }
+    static Float4 loadU(const float* p) { return load(p); }
+    void store(float* p) const { for (int i = 0; i < 4; ++i) p[i] = v[i]; }
+    void storeU(float* p) const { store(p); }
+    static Float4 loadInt32(const int32_t* p) {
+        return set(static_cast<float>(p[0]), static_cast<float>(p[1]), static_cast<float>(p[2]), static_cast<float>(p[3]));
+    }
+    void storeInt32(int32_t* p) const { for (int i = 0; i < 4; ++i) p[i] = static_cast<int32_t>(std::lrint(v[i])); }
+
+    friend Float4 operator+(Float4 a, Float4 b) { return set(a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]); }
+    friend Float4 operator-(Float4 a, Float4 b) { return set(a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]); }
+    friend Float4 operator*(Float4 a, Float4 b) { return set(a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]); }
+    friend Float4 min(Float4 a, Float4 b) {
+        return set(a.v[0] < b.v[0] ? a.v[0] : b.v[0], a.v[1] < b.v[1] ? a.v[1] : b.v[1],
+                   a.v[2] < b.v[2] ? a.v[2] : b.v[2], a.v[3] < b.v[3] ? a.v[3] : b.v[3]);
+    }
+    friend Float4 max(Float4 a, Float4 b) {
+        return set(a.v[0] > b.v[0] ? a.v[0] : b.v[0], a.v[1] > b.v[1] ? a.v[1] : b.v[1],
+                   a.v[2] > b.v[2] ? a.v[2] : b.v[2], a.v[3] > b.v[3] ? a.v[3] : b.v[3]);
+    }
+
+    friend Float4 abs(Float4 a) { return set(std::fabs(a.v[0]), std::fabs(a.v[1]), std::fabs(a.v[2]), std::fabs(a.v[3])); }
+
+    friend Float4 operator>(Float4 a, Float4 b) {
+        return mask(a.v[0] > b.v[0], a.v[1] > b.v[1], a.v[2] > b.v[2], a.v[3] > b.v[3]);
+    }
+    friend Float4 operator==(Float4 a, Float4 b) {
+        return mask(a.v[0] == b.v[0], a.v[1] == b.v[1], a.v[2] == b.v[2], a.v[3] == b.v[3]);
+    }
+    friend Float4 operator&(Float4 a, Float4 b) {
+        Float4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = fromBits(toBits(a.v[i]) & toBits(b.v[i]));
+        return r;
+    }
+    friend Float4 select(Float4 m, Float4 a, Float4 b) {
+        Float4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = toBits(m.v[i]) != 0 ? a.v[i] : b.v[i];
+        return r;
+    }
+
+    float sum() const { return (v[0] + v[1]) + (v[2] + v[3]); }
+
+private:
+    static uint32_t toBits(float x) { uint32_t b; std::memcpy(&b, &x, sizeof b); return b; }
+    static float fromBits(uint32_t b) { float x; std::memcpy(&x, &b, sizeof x); return x; }
+    static Float4 mask(bool a, bool b, bool c, bool d) {
+        const float on = fromBits(0xFFFFFFFFu);
+        return set(a ? on : 0.0f, b ? on : 0.0f, c ? on : 0.0f, d ? on : 0.0f);
+    }
+
+public:
+#endif
+
+    Float4& operator+=(Float4 other) { return *this = *this + other; }
+    Float4& operator*=(Float4 other) { return *this = *this * other; }
+};
+
+// Sum of a[i] * b[i]. count must be a multiple of 8 and a 16-byte aligned;
+// b may sit at any address, so b can slide along a signal history.
+inline float dotProduct(const float* a, const float* b, size_t count) {
+    Float4 even = Float4::zero();
+    Float4 odd = Float4::zero();
+    for (size_t i = 0; i < count; i += 8) {
+        even += Float4::load(a + i) * Float4::loadU(b + i);
+        odd += Float4::load(a + i + 4) * Float4::loadU(b + i + 4);
+    }
+    return (even + odd).sum();
+}
+
+} // namespace utils
+} // namespace song_processor
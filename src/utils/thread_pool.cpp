@@ -0,0 +1,235 @@
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace song_processor {
+namespace utils {
+
+class ThreadPool::Impl {
+public:
+    using Task = std::function<void()>;
+
+    // Deques are locked individually, so owners and thieves only contend
+    // when they touch the same worker
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex stateMutex;
+    std::condition_variable wake;   // Tasks queued or stopping
+    std::condition_variable idle;   // pending dropped to zero
+    // Tasks sitting in some deque. Counted after the push, so the count
+    // never runs ahead of the deques; it dips below zero while a task
+    // taken straight away has not been counted yet.
+    std::atomic<std::ptrdiff_t> queued{0};
+    size_t pending = 0;             // Submitted but not finished
+    bool stopping = false;
+    std::exception_ptr firstError;
+
+    std::atomic<size_t> nextWorker{0};
+
+    // Identifies the pool and deque of the calling worker thread
+    static thread_local Impl* currentPool;
+    static thread_local size_t currentIndex;
+
+    void run(size_t index);
+    bool take(size_t index, Task& task);
+    void finish(std::exception_ptr error);
+};
+
+thread_local ThreadPool::Impl* ThreadPool::Impl::currentPool = nullptr;
+thread_local size_t ThreadPool::Impl::currentIndex = 0;
+
+bool ThreadPool::Impl::take(size_t index, Task& task) {
+    {
+        Worker& own = *workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --queued;
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < workers.size(); ++offset) {
+        Worker& victim = *workers[(index + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --queued;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::Impl::finish(std::exception_ptr error) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (error && !firstError) {
+        firstError = error;
+    }
+    if (--pending == 0) {
+        idle.notify_all();
+    }
+}
+
+void ThreadPool::Impl::run(size_t index) {
+    currentPool = this;
+    currentIndex = index;
+
+    for (;;) {
+        Task task;
+        if (take(index, task)) {
+            std::exception_ptr error;
+            try {
+                task();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            finish(error);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(stateMutex);
+        wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0) {
+            return;
+        }
+    }
+}
+
+ThreadPool::ThreadPool(size_t threads) : pImpl(std::make_unique<Impl>()) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (size_t i = 0; i < threads; ++i) {
+        pImpl->workers.push_back(std::make_unique<Impl::Worker>());
+    }
+    pImpl->threads.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        pImpl->threads.emplace_back([this, i] { pImpl->run(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+        pImpl->stopping = true;
+    }
+    pImpl->wake.notify_all();
+    for (auto& thread : pImpl->threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    const size_t index = Impl::currentPool == pImpl.get()
+                             ? Impl::currentIndex
+                             : pImpl->nextWorker++ % pImpl->workers.size();
+
+    // pending goes up before the task is visible, so it cannot finish
+    // uncounted; queued only once it is in the deque, so a woken worker
+    // never finds the count ahead of the tasks and spins. Raising queued
+    // under the state lock means a worker about to sleep cannot miss it.
+    {
+        std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+        ++pImpl->pending;
+    }
+    {
+        Impl::Worker& worker = *pImpl->workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+        ++pImpl->queued;
+    }
+    pImpl->wake.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(pImpl->stateMutex);
+    pImpl->idle.wait(lock, [this] { return pImpl->pending == 0; });
+    if (pImpl->firstError) {
+        std::exception_ptr error = pImpl->firstError;
+        pImpl->firstError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) return;
+
+    // Helpers that start after every index is claimed touch only this
+    // shared state, never body, so the caller may return before they run
+    struct Progress {
+        std::atomic<size_t> next{0};
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t finished = 0;
+        std::exception_ptr error;
+    };
+    auto progress = std::make_shared<Progress>();
+    const std::function<void(size_t)>* work = &body;
+
+    auto drain = [progress, count, work] {
+        for (size_t i = progress->next++; i < count; i = progress->next++) {
+            std::exception_ptr error;
+            try {
+                (*work)(i);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(progress->mutex);
+            if (error && !progress->error) {
+                progress->error = error;
+            }
+            if (++progress->finished == count) {
+                progress->done.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(count - 1, getThreadCount());
+    for (size_t h = 0; h < helpers; ++h) {
+        try {
+            submit(drain);
+        } catch (...) {
+            break; // The caller picks up the rest
+        }
+    }
+    drain();
+
+    std::unique_lock<std::mutex> lock(progress->mutex);
+    progress->done.wait(lock, [&] { return progress->finished == count; });
+    if (progress->error) {
+        std::rethrow_exception(progress->error);
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return pImpl->threads.size();
+}
+
+} // namespace utils
+} // namespace song_processor